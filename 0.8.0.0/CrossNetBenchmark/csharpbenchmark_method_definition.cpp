@@ -861,7 +861,8 @@ void ::CSharpBenchmark::_Benchmark::GcTest::__Trace__(unsigned char currentMark)
         }
         for (num2 = 0 ; (num2 < ::CSharpBenchmark::_Benchmark::GcTest::NUM_TOGGLE) ; num2++)
         {
-            ::CSharpBenchmark::_Benchmark::GcTest__Toggle * toggle2 = (::CSharpBenchmark::_Benchmark::GcTest__Toggle::__Create__(true));
+            ::CrossNetRuntime::StackObject< ::CSharpBenchmark::_Benchmark::GcTest__Toggle > __temp10750__;
+            ::CSharpBenchmark::_Benchmark::GcTest__Toggle * toggle2 = (__temp10750__.Get()->__ctor__(true), __temp10750__.Get());
         }
         ::CSharpBenchmark::_Benchmark::GcTest__NthToggle * toggle3 = (::CSharpBenchmark::_Benchmark::GcTest__NthToggle::__Create__(true, 3));
         for (num2 = 0 ; (num2 < 8) ; num2++)
@@ -870,7 +871,8 @@ void ::CSharpBenchmark::_Benchmark::GcTest::__Trace__(unsigned char currentMark)
         }
         for (num2 = 0 ; (num2 < ::CSharpBenchmark::_Benchmark::GcTest::NUM_TOGGLE) ; num2++)
         {
-            ::CSharpBenchmark::_Benchmark::GcTest__NthToggle * toggle4 = (::CSharpBenchmark::_Benchmark::GcTest__NthToggle::__Create__(true, 3));
+            ::CrossNetRuntime::StackObject< ::CSharpBenchmark::_Benchmark::GcTest__NthToggle > __temp10751__;
+            ::CSharpBenchmark::_Benchmark::GcTest__NthToggle * toggle4 = (__temp10751__.Get()->__ctor__(true, 3), __temp10751__.Get());
         }
         for (num2 = 0 ; (num2 < 5) ; num2++)
         {
@@ -1048,8 +1050,8 @@ void ::CSharpBenchmark::_Benchmark::MatrixTest::__Trace__(unsigned char currentM
 ::System::Array__G< ::System::Int32 > * CSharpBenchmark::_Benchmark::MatrixTest::mkmatrix(::System::Int32 rows, ::System::Int32 cols)
 {
     ::System::Int32 num = 1;
-    ::System::Array__G< ::System::Int32 > * __temp10750__ = ::System::Array__G< ::System::Int32 >::__Create__(rows, cols);
-    ::System::Array__G< ::System::Int32 > * numArray = __temp10750__;
+    ::System::Array__G< ::System::Int32 > * __temp10752__ = ::System::Array__G< ::System::Int32 >::__Create__(rows, cols);
+    ::System::Array__G< ::System::Int32 > * numArray = __temp10752__;
     for (::System::Int32 i = 0 ; (i < rows) ; i++)
     {
         for (::System::Int32 j = 0 ; (j < cols) ; j++)
@@ -1079,8 +1081,8 @@ void ::CSharpBenchmark::_Benchmark::MatrixTest::__Trace__(unsigned char currentM
 {
     ::System::Array__G< ::System::Int32 > * numArray = ::CSharpBenchmark::_Benchmark::MatrixTest::mkmatrix(::CSharpBenchmark::_Benchmark::MatrixTest::SIZE, ::CSharpBenchmark::_Benchmark::MatrixTest::SIZE);
     ::System::Array__G< ::System::Int32 > * numArray2 = ::CSharpBenchmark::_Benchmark::MatrixTest::mkmatrix(::CSharpBenchmark::_Benchmark::MatrixTest::SIZE, ::CSharpBenchmark::_Benchmark::MatrixTest::SIZE);
-    ::System::Array__G< ::System::Int32 > * __temp10751__ = ::System::Array__G< ::System::Int32 >::__Create__(::CSharpBenchmark::_Benchmark::MatrixTest::SIZE, ::CSharpBenchmark::_Benchmark::MatrixTest::SIZE);
-    ::System::Array__G< ::System::Int32 > * numArray3 = __temp10751__;
+    ::System::Array__G< ::System::Int32 > * __temp10753__ = ::System::Array__G< ::System::Int32 >::__Create__(::CSharpBenchmark::_Benchmark::MatrixTest::SIZE, ::CSharpBenchmark::_Benchmark::MatrixTest::SIZE);
+    ::System::Array__G< ::System::Int32 > * numArray3 = __temp10753__;
     for (::System::Int32 i = 0 ; (i < N) ; i++)
     {
         ::CSharpBenchmark::_Benchmark::MatrixTest::mmult(::CSharpBenchmark::_Benchmark::MatrixTest::SIZE, ::CSharpBenchmark::_Benchmark::MatrixTest::SIZE, numArray, numArray2, numArray3);
@@ -1306,8 +1308,8 @@ void ::CSharpBenchmark::_Benchmark::HeapSortTest::__Trace__(unsigned char curren
     for (::System::Int32 i = 0 ; (i < N) ; i++)
     {
         ::System::Int32 num2;
-        ::System::Array__G< ::System::Double > * __temp10752__ = ::System::Array__G< ::System::Double >::__Create__((::CSharpBenchmark::_Benchmark::HeapSortTest::count + 1));
-        ::System::Array__G< ::System::Double > * ra = __temp10752__;
+        ::System::Array__G< ::System::Double > * __temp10754__ = ::System::Array__G< ::System::Double >::__Create__((::CSharpBenchmark::_Benchmark::HeapSortTest::count + 1));
+        ::System::Array__G< ::System::Double > * ra = __temp10754__;
         ::CSharpBenchmark::_Benchmark::HeapSortTest::last = 42LL;
         for (num2 = 0 ; (num2 <= ::CSharpBenchmark::_Benchmark::HeapSortTest::count) ; num2++)
         {
@@ -1734,8 +1736,8 @@ void CSharpBenchmark::_Benchmark::ListTest__IntDeQueue::__ctor__(::System::Int32
     this->end = 0;
     this->size = 0;
     this->temp = 0;
-    ::System::Array__G< ::System::Int32 > * __temp10753__ = ::System::Array__G< ::System::Int32 >::__Create__((Size + 1));
-    this->data = __temp10753__;
+    ::System::Array__G< ::System::Int32 > * __temp10755__ = ::System::Array__G< ::System::Int32 >::__Create__((Size + 1));
+    this->data = __temp10755__;
     this->size = (Size + 1);
 }
 }
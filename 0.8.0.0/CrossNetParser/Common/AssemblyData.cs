@@ -28,5 +28,7 @@ namespace CrossNet.Common
         public OutputMode Mode;
         public string MainInclude;
         public string AssemblyName;
+        // Zero if the types use dynamic ids
+        public int FirstStaticId;
     }
 }
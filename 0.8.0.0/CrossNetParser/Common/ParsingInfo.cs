@@ -100,6 +100,13 @@ namespace CrossNet.Common
         public string AnonymousMethodClass = null;
         public bool AtLeastOneAnonymousMethod = false;
 
+        // Code for escape analysis
+        // Set by the parent expression when the next parsed expression is used in a way that can't make a reference escape
+        // (like the target of a field reference). It is reset as soon as the next expression is parsed (even a null one).
+        public bool NonEscapingUse = false;
+        // Set when 'this' (or 'base') escapes the method currently parsed
+        public bool ThisEscapes = false;
+
         public IDictionary<string, AnonymousVariable> Variables
         {
             get
@@ -213,6 +220,82 @@ namespace CrossNet.Common
             AnonymousMethodClass = null;
         }
 
+        public void DeclareStackAllocationCandidate(string variableName, IObjectCreateExpression objectCreate)
+        {
+            if (mStackAllocationCandidates == null)
+            {
+                mStackAllocationCandidates = new Dictionary<string, IObjectCreateExpression>();
+            }
+            if (mStackAllocationCandidates.ContainsKey(variableName))
+            {
+                // Same name used for two different creations (like in two sibling scopes)
+                // We only track one creation per name, so be conservative
+                EscapeVariable(variableName);
+                return;
+            }
+            mStackAllocationCandidates.Add(variableName, objectCreate);
+        }
+
+        public void EscapeVariable(string variableName)
+        {
+            if (mEscapingVariables == null)
+            {
+                mEscapingVariables = new Dictionary<string, string>();
+            }
+            mEscapingVariables[variableName] = variableName;
+        }
+
+        public void ResolveStackAllocations()
+        {
+            mStackAllocations = null;
+            if (mStackAllocationCandidates == null)
+            {
+                return;
+            }
+
+            if (AtLeastOneAnonymousMethod == false)
+            {
+                // Anonymous methods move local variables to the heap, in that case we don't want to track the variables at all
+                foreach (KeyValuePair<string, IObjectCreateExpression> candidate in mStackAllocationCandidates)
+                {
+                    if ((mEscapingVariables != null) && mEscapingVariables.ContainsKey(candidate.Key))
+                    {
+                        continue;
+                    }
+                    if (mStackAllocations == null)
+                    {
+                        mStackAllocations = new Dictionary<IObjectCreateExpression, string>();
+                    }
+                    mStackAllocations.Add(candidate.Value, candidate.Key);
+                }
+            }
+
+            // The candidates and escaping variables are only valid for the method that has been parsed
+            mStackAllocationCandidates.Clear();
+            if (mEscapingVariables != null)
+            {
+                mEscapingVariables.Clear();
+            }
+        }
+
+        public bool IsStackAllocation(IObjectCreateExpression objectCreate)
+        {
+            if (mStackAllocations == null)
+            {
+                return (false);
+            }
+            return (mStackAllocations.ContainsKey(objectCreate));
+        }
+
+        public void ClearStackAllocations()
+        {
+            mStackAllocations = null;
+            if (mEscapingVariables != null)
+            {
+                mEscapingVariables.Clear();
+            }
+        }
+
         // Code for finally statements
 #if DISABLED    // Doesn't handle completely finally
         private Stack<StringData> mFinallyStatements = null;
@@ -458,6 +541,9 @@ namespace CrossNet.Common
         private Stack<bool> mStackOfInterfaceCalls = null;
         private Stack<string> mStackOfPropertyIndexerTarget = null;
         private IDictionary<string, AnonymousVariable> mVariablesUsedInAnonymousMethods = null;
+        private IDictionary<string, IObjectCreateExpression> mStackAllocationCandidates = null;
+        private IDictionary<string, string> mEscapingVariables = null;
+        private IDictionary<IObjectCreateExpression, string> mStackAllocations = null;
     }
 
     public struct StatementState
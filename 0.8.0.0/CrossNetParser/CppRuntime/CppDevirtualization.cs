@@ -0,0 +1,267 @@
+/*
+    CrossNet - Copyright (c) 2007 Olivier Nallet
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+    OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Text;
+
+using Reflector;
+using Reflector.CodeModel;
+
+using CrossNet.Common;
+using CrossNet.Interfaces;
+using CrossNet.Net;
+
+namespace CrossNet.CppRuntime
+{
+    // Devirtualization of the virtual calls whose target is known at parsing time
+    //
+    // In C++, "instance->Type::Method()" calls directly Type::Method() without using the vtable
+    // (and the C++ compiler can inline it). The call is only qualified when we can prove that
+    // every possible dynamic type of the instance uses the same implementation:
+    //  - The static type of the instance is sealed.
+    //  - Or the implementation is sealed (C# "sealed override").
+    //  - Or the static type is not visible outside its assembly, and no type of the assembly derived from it overrides the method.
+    //    (we don't support InternalsVisibleTo here, another assembly could derive from the internal type then).
+    //
+    // Like the escape analysis, the answer is conservative: generics, runtime types (no translated declaration)
+    // and methods hidden with "new" are never devirtualized.
+    class CppDevirtualization
+    {
+        // Returns the type that contains the implementation to call directly, or null if the call must stay virtual
+        public static ITypeInfo GetDirectCallType(ITypeInfo instanceType, IMethodReference methodReference)
+        {
+            if ((instanceType == null) || (methodReference == null))
+            {
+                return (null);
+            }
+            if ((instanceType.Type != ObjectType.CLASS) || instanceType.IsValueType || instanceType.IsGeneric)
+            {
+                return (null);
+            }
+            if ((methodReference.GenericArguments.Count != 0) || (methodReference.HasThis == false))
+            {
+                return (null);
+            }
+
+            ITypeInfo declaringType = TypeInfoManager.GetTypeInfo(methodReference.DeclaringType);
+            if ((declaringType == null) || (declaringType.Type != ObjectType.CLASS) || declaringType.IsGeneric)
+            {
+                return (null);
+            }
+
+            // The method must be accessible from the instance without any conversion
+            ITypeInfo currentType = instanceType;
+            while ((currentType != null) && (currentType != declaringType))
+            {
+                currentType = currentType.BaseType;
+            }
+            if (currentType == null)
+            {
+                return (null);
+            }
+
+            // Find the implementation seen from the static type of the instance
+            ITypeInfo implementationType = null;
+            IMethodDeclaration implementation = null;
+            currentType = instanceType;
+            while (currentType != null)
+            {
+                if (currentType.TypeDeclaration == null)
+                {
+                    // Not translated, we don't know what's in there
+                    return (null);
+                }
+                IMethodDeclaration methodDeclaration = FindMethodDeclaration(currentType.TypeDeclaration, methodReference);
+                if (methodDeclaration != null)
+                {
+                    if (methodDeclaration.Virtual == false)
+                    {
+                        // Not virtual, there is nothing to gain...
+                        return (null);
+                    }
+                    if (methodDeclaration.NewSlot && (currentType != declaringType))
+                    {
+                        // A new virtual method hides the one we are calling
+                        return (null);
+                    }
+                    if (methodDeclaration.Abstract || ((methodDeclaration.Body is IBlockStatement) == false))
+                    {
+                        return (null);
+                    }
+                    implementationType = currentType;
+                    implementation = methodDeclaration;
+                    break;
+                }
+                if (currentType == declaringType)
+                {
+                    // We should have found it at that level...
+                    return (null);
+                }
+                currentType = currentType.BaseType;
+            }
+            if (implementationType == null)
+            {
+                return (null);
+            }
+
+            if (instanceType.TypeDeclaration.Sealed || implementation.Final)
+            {
+                return (implementationType);
+            }
+            if (IsVisibleOutsideAssembly(instanceType.TypeDeclaration))
+            {
+                return (null);
+            }
+            if (IsOverriden(instanceType, methodReference))
+            {
+                return (null);
+            }
+            return (implementationType);
+        }
+
+        private static bool IsVisibleOutsideAssembly(ITypeDeclaration typeDeclaration)
+        {
+            switch (typeDeclaration.Visibility)
+            {
+                case TypeVisibility.Private:
+                case TypeVisibility.NestedPrivate:
+                case TypeVisibility.NestedAssembly:
+                case TypeVisibility.NestedFamilyAndAssembly:
+                    return (false);
+
+                default:
+                    break;
+            }
+
+            ITypeReference owner = typeDeclaration.Owner as ITypeReference;
+            if (owner == null)
+            {
+                return (true);
+            }
+            ITypeInfo ownerTypeInfo = TypeInfoManager.GetTypeInfo(owner);
+            if ((ownerTypeInfo == null) || (ownerTypeInfo.TypeDeclaration == null))
+            {
+                return (true);
+            }
+            return (IsVisibleOutsideAssembly(ownerTypeInfo.TypeDeclaration));
+        }
+
+        private static bool IsOverriden(ITypeInfo instanceType, IMethodReference methodReference)
+        {
+            IModule module = GetModule(instanceType.TypeDeclaration);
+            if (module == null)
+            {
+                return (true);
+            }
+
+            IList<ITypeInfo> derivedTypes;
+            if (sDerivedTypes.TryGetValue(instanceType, out derivedTypes) == false)
+            {
+                derivedTypes = new List<ITypeInfo>();
+                foreach (ITypeDeclaration typeDeclaration in module.Types)
+                {
+                    AddDerivedTypes(instanceType, typeDeclaration, derivedTypes);
+                }
+                sDerivedTypes[instanceType] = derivedTypes;
+            }
+
+            foreach (ITypeInfo derivedType in derivedTypes)
+            {
+                if (derivedType.TypeDeclaration == null)
+                {
+                    return (true);
+                }
+                // Any method with the same signature is considered as an override (even if it is a new slot)
+                if (FindMethodDeclaration(derivedType.TypeDeclaration, methodReference) != null)
+                {
+                    return (true);
+                }
+            }
+            return (false);
+        }
+
+        private static void AddDerivedTypes(ITypeInfo instanceType, ITypeDeclaration typeDeclaration, IList<ITypeInfo> derivedTypes)
+        {
+            ITypeInfo typeInfo = TypeInfoManager.GetTypeInfo(typeDeclaration);
+            if (typeInfo != null)
+            {
+                ITypeInfo baseType = typeInfo.BaseType;
+                while (baseType != null)
+                {
+                    if (baseType == instanceType)
+                    {
+                        derivedTypes.Add(typeInfo);
+                        break;
+                    }
+                    baseType = baseType.BaseType;
+                }
+            }
+
+            foreach (ITypeDeclaration nestedType in typeDeclaration.NestedTypes)
+            {
+                AddDerivedTypes(instanceType, nestedType, derivedTypes);
+            }
+        }
+
+        private static IModule GetModule(ITypeDeclaration typeDeclaration)
+        {
+            object owner = typeDeclaration.Owner;
+            while (owner is ITypeReference)
+            {
+                ITypeInfo ownerTypeInfo = TypeInfoManager.GetTypeInfo((ITypeReference)owner);
+                if ((ownerTypeInfo == null) || (ownerTypeInfo.TypeDeclaration == null))
+                {
+                    return (null);
+                }
+                owner = ownerTypeInfo.TypeDeclaration.Owner;
+            }
+            return (owner as IModule);
+        }
+
+        private static IMethodDeclaration FindMethodDeclaration(ITypeDeclaration typeDeclaration, IMethodReference methodReference)
+        {
+            int numParameters = methodReference.Parameters.Count;
+            foreach (IMethodDeclaration methodDeclaration in typeDeclaration.Methods)
+            {
+                if (methodDeclaration.Name != methodReference.Name)
+                {
+                    continue;
+                }
+                if (methodDeclaration.Parameters.Count != numParameters)
+                {
+                    continue;
+                }
+                bool sameParameters = true;
+                for (int i = 0; i < numParameters; ++i)
+                {
+                    if (methodDeclaration.Parameters[i].ParameterType.CompareTo(methodReference.Parameters[i].ParameterType) != 0)
+                    {
+                        sameParameters = false;
+                        break;
+                    }
+                }
+                if (sameParameters)
+                {
+                    return (methodDeclaration);
+                }
+            }
+            return (null);
+        }
+
+        private static IDictionary<ITypeInfo, IList<ITypeInfo>> sDerivedTypes = new Dictionary<ITypeInfo, IList<ITypeInfo>>();
+    }
+}
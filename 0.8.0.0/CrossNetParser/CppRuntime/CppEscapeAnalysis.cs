@@ -0,0 +1,312 @@
+/*
+    CrossNet - Copyright (c) 2007 Olivier Nallet
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+    OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Text;
+
+using Reflector;
+using Reflector.CodeModel;
+
+using CrossNet.Common;
+using CrossNet.Interfaces;
+using CrossNet.Net;
+
+namespace CrossNet.CppRuntime
+{
+    // Escape analysis used to create some objects on the stack instead of the GC heap
+    //
+    // The pre-parsing of each method tracks the local variables initialized with "new" at declaration time.
+    // Any use of the variable that is not known as safe makes it escape (stored, returned, passed as parameter, captured...).
+    // The only safe uses are:
+    //  - Target of a field reference (read or write the field, not the reference itself).
+    //  - Target of a method or property call, if the callee doesn't let "this" escape.
+    //  - Comparison with null.
+    //
+    // This class answers the question "does the callee let 'this' escape?" by pre-parsing the callee's body.
+    // For a constructor, the constructor called by the initializer (explicit or not) must be safe as well.
+    // The answer is conservative: unknown bodies (external assemblies, abstract / virtual methods), recursion,
+    // anonymous methods are all considered as escaping.
+    class CppEscapeAnalysis
+    {
+        public static bool CanCreateOnStack(IObjectCreateExpression expression)
+        {
+            if ((expression.Initializer != null) && (expression.Initializer.Expressions.Count != 0))
+            {
+                // Keep the initializer code path as is, the temporary variable is shared with the GC version
+                return (false);
+            }
+            if (expression.Constructor == null)
+            {
+                return (false);
+            }
+
+            ITypeInfo typeInfo = TypeInfoManager.GetTypeInfo(expression.Type);
+            if (typeInfo == null)
+            {
+                return (false);
+            }
+
+            bool canCreateOnStack;
+            if (sTypes.TryGetValue(typeInfo, out canCreateOnStack) == false)
+            {
+                canCreateOnStack = IsTypeSupported(typeInfo);
+                sTypes[typeInfo] = canCreateOnStack;
+            }
+            if (canCreateOnStack == false)
+            {
+                return (false);
+            }
+
+            // Finally the constructor itself must not store "this" somewhere...
+            return (IsThisSafe(expression.Constructor));
+        }
+
+        public static bool IsThisSafe(IMethodReference methodReference)
+        {
+            if (methodReference == null)
+            {
+                return (false);
+            }
+
+            ITypeInfo declaringType = TypeInfoManager.GetTypeInfo(methodReference.DeclaringType);
+            if (declaringType == null)
+            {
+                return (false);
+            }
+            if ((declaringType.DotNetFullName == OBJECT_TYPE) && (methodReference.Name == CONSTRUCTOR))
+            {
+                // System::Object::__ctor__() does nothing, this is the end of every constructor chain
+                return (true);
+            }
+
+            IMethodDeclaration methodDeclaration = FindMethodDeclaration(declaringType, methodReference);
+            if (methodDeclaration == null)
+            {
+                return (false);
+            }
+            return (IsThisSafe(declaringType, methodDeclaration));
+        }
+
+        // Called by the code generation once the body of a method has been pre-parsed
+        //  The result is kept so the body doesn't have to be parsed again if the method is called on a stack candidate
+        public static void OnBodyParsed(IStatement body, ParsingInfo info)
+        {
+            sBodies[body] = (info.AtLeastOneAnonymousMethod == false) && (info.ThisEscapes == false);
+        }
+
+        private static bool IsThisSafe(ITypeInfo declaringType, IMethodDeclaration methodDeclaration)
+        {
+            bool thisSafe;
+            if (sMethods.TryGetValue(methodDeclaration, out thisSafe))
+            {
+                // Note that a method currently analyzed is stored as escaping, so recursion is conservative
+                return (thisSafe);
+            }
+            sMethods[methodDeclaration] = false;
+
+            thisSafe = AnalyzeMethod(declaringType, methodDeclaration);
+            sMethods[methodDeclaration] = thisSafe;
+            return (thisSafe);
+        }
+
+        private static bool AnalyzeMethod(ITypeInfo declaringType, IMethodDeclaration methodDeclaration)
+        {
+            if (methodDeclaration.Abstract || (methodDeclaration.Virtual && (methodDeclaration.Final == false)))
+            {
+                // The actual implementation can be overriden, we don't know what will be called
+                return (false);
+            }
+            if (methodDeclaration.GenericArguments.Count != 0)
+            {
+                return (false);
+            }
+            IBlockStatement body = methodDeclaration.Body as IBlockStatement;
+            if (body == null)
+            {
+                // Not translated (external assembly, extern method...)
+                return (false);
+            }
+
+            IConstructorDeclaration constructorDeclaration = methodDeclaration as IConstructorDeclaration;
+            if ((constructorDeclaration != null) && (IsInitializerSafe(declaringType, constructorDeclaration) == false))
+            {
+                return (false);
+            }
+
+            bool thisSafe;
+            if (sBodies.TryGetValue(body, out thisSafe) == false)
+            {
+                // The method has not been generated yet
+                // Use the same pre-parsing as the code generation, but on a separate parsing info
+                // As such the state of the method currently parsed is not modified
+                ParsingInfo info = new ParsingInfo(declaringType.TypeDeclaration);
+                LanguageManager.StatementGenerator.ParseStatement(body, info);
+                OnBodyParsed(body, info);
+                thisSafe = sBodies[body];
+            }
+            return (thisSafe);
+        }
+
+        private static bool IsInitializerSafe(ITypeInfo declaringType, IConstructorDeclaration constructorDeclaration)
+        {
+            IMethodInvokeExpression initializer = constructorDeclaration.Initializer;
+            if ((initializer == null) || (initializer.Method == null))
+            {
+                // No initializer, the default constructor of the base type is called implicitly
+                ITypeInfo baseType = declaringType.BaseType;
+                if (baseType == null)
+                {
+                    // Deriving directly from System.Object (structs are not stack candidates)
+                    return (true);
+                }
+                IMethodDeclaration baseConstructor = FindDefaultConstructor(baseType);
+                if (baseConstructor == null)
+                {
+                    return (false);
+                }
+                return (IsThisSafe(baseType, baseConstructor));
+            }
+
+            // base(...) or this(...), the arguments are evaluated in the constructor, so "this" can escape through them too
+            ParsingInfo info = new ParsingInfo(declaringType.TypeDeclaration);
+            foreach (IExpression argument in initializer.Arguments)
+            {
+                LanguageManager.ExpressionGenerator.ParseExpression(argument, info);
+            }
+            if (info.AtLeastOneAnonymousMethod || info.ThisEscapes)
+            {
+                return (false);
+            }
+
+            IMethodReferenceExpression methodReferenceExpression = initializer.Method as IMethodReferenceExpression;
+            if (methodReferenceExpression == null)
+            {
+                return (false);
+            }
+            return (IsThisSafe(methodReferenceExpression.Method));
+        }
+
+        private static bool IsTypeSupported(ITypeInfo typeInfo)
+        {
+            if ((typeInfo.Type != ObjectType.CLASS) || typeInfo.IsValueType || typeInfo.IsPrimitiveType || typeInfo.IsGeneric)
+            {
+                return (false);
+            }
+
+            // Walk the hierarchy, we need to know every single type to make sure there is no finalizer
+            // (the finalizer is the C++ destructor, and it is never called for an object created on the stack)
+            // The runtime types (like strings, arrays, delegates) are filtered out as well as they don't have a translated declaration
+            ITypeInfo currentType = typeInfo;
+            while (currentType != null)
+            {
+                if (currentType.DotNetFullName == OBJECT_TYPE)
+                {
+                    return (true);
+                }
+                ITypeDeclaration typeDeclaration = currentType.TypeDeclaration;
+                if (typeDeclaration == null)
+                {
+                    return (false);
+                }
+                foreach (IMethodDeclaration methodDeclaration in typeDeclaration.Methods)
+                {
+                    if (methodDeclaration.Body is IBlockStatement)
+                    {
+                        if ((methodDeclaration.Name == "Finalize") && (methodDeclaration.Parameters.Count == 0))
+                        {
+                            return (false);
+                        }
+                        continue;
+                    }
+                    if ((methodDeclaration.Abstract == false) && (methodDeclaration.Body != null))
+                    {
+                        // There is a body that has not been translated, so it's not part of the parsed assemblies
+                        return (false);
+                    }
+                }
+                if (currentType.BaseType == null)
+                {
+                    // The type info doesn't keep System.Object as base type (same for delegates, structs and enums)
+                    // So a class without base type derives directly from System.Object
+                    return (currentType.Type == ObjectType.CLASS);
+                }
+                currentType = currentType.BaseType;
+            }
+            return (false);
+        }
+
+        private static IMethodDeclaration FindMethodDeclaration(ITypeInfo declaringType, IMethodReference methodReference)
+        {
+            // Resolve() returns the non-translated method, we need the translated one to look at the body
+            ITypeDeclaration typeDeclaration = declaringType.TypeDeclaration;
+            if (typeDeclaration == null)
+            {
+                return (null);
+            }
+            int numParameters = methodReference.Parameters.Count;
+            foreach (IMethodDeclaration methodDeclaration in typeDeclaration.Methods)
+            {
+                if (methodDeclaration.Name != methodReference.Name)
+                {
+                    continue;
+                }
+                if (methodDeclaration.Parameters.Count != numParameters)
+                {
+                    continue;
+                }
+                bool sameParameters = true;
+                for (int i = 0; i < numParameters; ++i)
+                {
+                    if (methodDeclaration.Parameters[i].ParameterType.CompareTo(methodReference.Parameters[i].ParameterType) != 0)
+                    {
+                        sameParameters = false;
+                        break;
+                    }
+                }
+                if (sameParameters)
+                {
+                    return (methodDeclaration);
+                }
+            }
+            return (null);
+        }
+
+        private static IMethodDeclaration FindDefaultConstructor(ITypeInfo typeInfo)
+        {
+            ITypeDeclaration typeDeclaration = typeInfo.TypeDeclaration;
+            if (typeDeclaration == null)
+            {
+                return (null);
+            }
+            foreach (IMethodDeclaration methodDeclaration in typeDeclaration.Methods)
+            {
+                if ((methodDeclaration.Name == CONSTRUCTOR) && (methodDeclaration.Parameters.Count == 0))
+                {
+                    return (methodDeclaration);
+                }
+            }
+            return (null);
+        }
+
+        private const string OBJECT_TYPE = "System.Object";
+        private const string CONSTRUCTOR = ".ctor";
+        private static IDictionary<ITypeInfo, bool> sTypes = new Dictionary<ITypeInfo, bool>();
+        private static IDictionary<IMethodDeclaration, bool> sMethods = new Dictionary<IMethodDeclaration, bool>();
+        // Result of the pre-parsing of each body: true if "this" doesn't escape (the initializer is not part of the body)
+        private static IDictionary<IStatement, bool> sBodies = new Dictionary<IStatement, bool>();
+    }
+}
@@ -1653,7 +1653,7 @@ namespace CrossNet.CppRuntime
 
         private static string NormalizeStringExpression(string text)
         {
-            StringBuilder sb = new StringBuilder("\"", text.Length);
+            StringBuilder sb = new StringBuilder("CROSSNET_TEXT(\"", text.Length);
             foreach (char c in text)
             {
                 ushort value = (ushort)c;
@@ -1666,7 +1666,7 @@ namespace CrossNet.CppRuntime
                     // Usually reporting that the number is too wide
                     // We solve this issue by breaking the string sequence
                     sb.Append(value.ToString("x4"));
-                    sb.Append("\" L\"");
+                    sb.Append("\") CROSSNET_TEXT(\"");
                 }
                 else
                 {
@@ -1687,7 +1687,7 @@ namespace CrossNet.CppRuntime
                             // So if you have, 0-9 a-f characters after the hex sequence, the compiler will still read them and interpret them wrongly
                             // Usually reporting that the number is too wide
                             // We solve this issue by breaking the string sequence
-                            sb.Append("\\x0000\" L\"");
+                            sb.Append("\\x0000\") CROSSNET_TEXT(\"");
                             break;
                         case '\n':
                             sb.Append("\\n");
@@ -1702,7 +1702,7 @@ namespace CrossNet.CppRuntime
                     }
                 }
             }
-            sb.Append("\"");
+            sb.Append("\")");
             return (sb.ToString());
         }
 
@@ -1727,7 +1727,7 @@ namespace CrossNet.CppRuntime
                     // We need to add the quote for the strings
 #if false   //  Deactivated as we are doing string pooling
                     string generatedString = NormalizeStringExpression((String)value);
-                    text = "::System::String::__Create__(L" + generatedString + ")";      // L for 16 bits char...
+                    text = "::System::String::__Create__(" + generatedString + ")";
 #else
                     text = StringPool.CreateString((String)value);
 #endif
@@ -1735,7 +1735,8 @@ namespace CrossNet.CppRuntime
                 }
                 else if (valueType == typeof(char))
                 {
-                    text = "L" + NormalizeCharExpression((Char)value);
+                    // CROSSNET_TEXT() adds the prefix that matches System::Char (L or u)
+                    text = "CROSSNET_TEXT(" + NormalizeCharExpression((Char)value) + ")";
                     type = LanguageManager.LocalTypeManager.TypeChar;
                 }
                 else if (valueType == typeof(bool))
@@ -2066,7 +2067,13 @@ namespace CrossNet.CppRuntime
         public StringData GenerateCodeMethodInvoke(IExpression passedExpression, ParsingInfo info)
         {
             IMethodInvokeExpression expression = (IMethodInvokeExpression)passedExpression;
-            StringData data = GenerateCode(expression.Method, info);
+            StringData data = CppStringConcat.GenerateCode(expression, info);
+            if (data != null)
+            {
+                // String concatenation, flattened in a single allocation
+                return (data);
+            }
+            data = GenerateCode(expression.Method, info);
             StringData arguments = GenerateCodeMethodInvokeArguments(expression.Arguments, info);
             data.AppendSameLine(arguments);
             return (data);
@@ -2544,12 +2551,19 @@ namespace CrossNet.CppRuntime
                             else
                             {
                                 data.AppendSameLine("->");
+
+                                if (useGenWrapper == false)
+                                {
+                                    // If only one implementation can be called, fully qualify the method so it is not a virtual call anymore
+                                    ITypeInfo directCallType = CppDevirtualization.GetDirectCallType(typeInfo, expression.Method);
+                                    if (directCallType != null)
+                                    {
+                                        data.AppendSameLine(directCallType.FullName + "::");
+                                    }
+                                }
                             }
                         }
 
-                        // TODO:    Add a potential optimization for sealed classes
-                        //          If the class is sealed, nothing prevent us to fully qualify the method (with the corresponding type)
-                        //          In some cases, we can actually do a static call instead of a virtual call...
                         data.AppendSameLine(methodReference);
                     }
                 }
@@ -2589,12 +2603,30 @@ namespace CrossNet.CppRuntime
                         }
                         else
                         {
-                            // Standard C++ call (we cast to the expected type just so we can have the correct method - like implicit cast from char to int).
-                            data = new StringData("(");
-                            StringData castedVersion = LanguageManager.LocalTypeManager.DoesNeedCast(localType, target.LocalType, target);
-                            castedVersion = AddWrapper(castedVersion, expression, useGenWrapper);
-                            data.AppendSameLine(castedVersion);
-                            data.AppendSameLine(")->");
+                            ITypeInfo directCallType = null;
+                            if (useGenWrapper == false)
+                            {
+                                directCallType = CppDevirtualization.GetDirectCallType(TypeInfoManager.GetTypeInfo(target.LocalType), expression.Method);
+                            }
+
+                            if (directCallType != null)
+                            {
+                                // The target derives from the type of the method, so there is no need to cast it
+                                // Fully qualify the method so it is not a virtual call anymore
+                                data = new StringData("(");
+                                data.AppendSameLine(target);
+                                data.AppendSameLine(")->");
+                                data.AppendSameLine(directCallType.FullName + "::");
+                            }
+                            else
+                            {
+                                // Standard C++ call (we cast to the expected type just so we can have the correct method - like implicit cast from char to int).
+                                data = new StringData("(");
+                                StringData castedVersion = LanguageManager.LocalTypeManager.DoesNeedCast(localType, target.LocalType, target);
+                                castedVersion = AddWrapper(castedVersion, expression, useGenWrapper);
+                                data.AppendSameLine(castedVersion);
+                                data.AppendSameLine(")->");
+                            }
                         }
                         data.AppendSameLine(methodReference);
                     }
@@ -2673,6 +2705,7 @@ namespace CrossNet.CppRuntime
             IObjectCreateExpression expression = (IObjectCreateExpression)passedExpression;
             StringData data;
             bool close = true;  // By default, there will be nested parenthesis
+            string stackVariable = null;
             
             ITypeInfo typeInfo = TypeInfoManager.GetTypeInfo(expression.Type);
             if (typeInfo != null)
@@ -2722,6 +2755,16 @@ namespace CrossNet.CppRuntime
                         data = new StringData("(" + typeInfo.FullName);
                     }
                 }
+                else if (info.IsStackAllocation(expression))
+                {
+                    // The instance never escapes the method, create it on the stack
+                    // The storage is declared before the statement so it lives as long as the variable
+                    // And we generate something like this:
+                    //  (__temp__.Get()->__ctor__(optParameters), __temp__.Get())
+                    stackVariable = CppUtil.GetNextTempVariable();
+                    info.AddToPreStatements(new StringData("::CrossNetRuntime::StackObject< " + typeInfo.FullName + " > " + stackVariable));
+                    data = new StringData("(" + stackVariable + ".Get()->__ctor__");
+                }
                 else
                 {
                     // For class type, we call the create method
@@ -2761,6 +2804,10 @@ namespace CrossNet.CppRuntime
             info.PushInterfaceCall(false);      // Construction is not an interface call
             StringData arguments = GenerateCodeMethodInvokeArguments(expression.Arguments, info);
             data.AppendSameLine(arguments);
+            if (stackVariable != null)
+            {
+                data.AppendSameLine(", " + stackVariable + ".Get()");
+            }
             if (close)
             {
                 data.AppendSameLine(")");
@@ -2990,6 +3037,7 @@ namespace CrossNet.CppRuntime
                         else
                         {
                             data.AppendSameLine("->");
+                            data.AppendSameLine(GetDirectPropertyScope(target, expression.Property, getProperty));
                         }
                     }
 
@@ -3039,6 +3087,7 @@ namespace CrossNet.CppRuntime
                     else
                     {
                         data.AppendSameLine("->");
+                        data.AppendSameLine(GetDirectPropertyScope(target, expression.Property, getProperty));
                     }
                 }
 
@@ -3074,6 +3123,28 @@ namespace CrossNet.CppRuntime
             return (data);
         }
 
+        private static string GetDirectPropertyScope(StringData target, IPropertyReference propertyReference, bool getProperty)
+        {
+            // Same as the method call, if only one accessor can be called, fully qualify it
+            if (target.LocalType == null)
+            {
+                // Interface call, there is nothing to do
+                return ("");
+            }
+            IPropertyDeclaration propertyDeclaration = propertyReference.Resolve();
+            if (propertyDeclaration == null)
+            {
+                return ("");
+            }
+            IMethodReference accessor = getProperty ? propertyDeclaration.GetMethod : propertyDeclaration.SetMethod;
+            ITypeInfo directCallType = CppDevirtualization.GetDirectCallType(TypeInfoManager.GetTypeInfo(target.LocalType), accessor);
+            if (directCallType == null)
+            {
+                return ("");
+            }
+            return (directCallType.FullName + "::");
+        }
+
         public StringData GenerateCodeSizeOf(IExpression passedExpression, ParsingInfo info)
         {
             ISizeOfExpression expression = (ISizeOfExpression)passedExpression;
@@ -3365,11 +3436,28 @@ namespace CrossNet.CppRuntime
 
         public void ParseExpression(IExpression expression, ParsingInfo info)
         {
+            // Escape analysis: a reference used anywhere else than in a known safe context escapes
+            //  The flag is reset even if there is no expression, otherwise it would apply to the next parsed expression
+            bool nonEscapingUse = info.NonEscapingUse;
+            info.NonEscapingUse = false;
             if (expression == null)
             {
                 return;
             }
 
+            if (nonEscapingUse == false)
+            {
+                if (expression is IVariableReferenceExpression)
+                {
+                    IVariableReferenceExpression variableReference = (IVariableReferenceExpression)expression;
+                    info.EscapeVariable(variableReference.Variable.Resolve().Name);
+                }
+                else if ((expression is IThisReferenceExpression) || (expression is IBaseReferenceExpression))
+                {
+                    info.ThisEscapes = true;
+                }
+            }
+
             // Try to use the cache first
             // Get the type of the expression (i.e. the implementation)
             Type expressionType = expression.GetType();
@@ -3652,6 +3740,15 @@ namespace CrossNet.CppRuntime
         public void ParseAssign(IExpression passedExpression, ParsingInfo info)
         {
             IAssignExpression expression = (IAssignExpression)passedExpression;
+            IVariableDeclarationExpression variableDeclaration = expression.Target as IVariableDeclarationExpression;
+            IObjectCreateExpression objectCreate = expression.Expression as IObjectCreateExpression;
+            if ((variableDeclaration != null) && (objectCreate != null) && CppEscapeAnalysis.CanCreateOnStack(objectCreate))
+            {
+                // Something like: MyClass c = new MyClass();
+                // If "c" doesn't escape the method, the instance can be created on the stack
+                info.DeclareStackAllocationCandidate(variableDeclaration.Variable.Name, objectCreate);
+            }
+            // Assigning a variable (other than at declaration time) makes it escape, as the target is not parsed as a safe use
             ParseExpression(expression.Target, info);
             ParseExpression(expression.Expression, info);
         }
@@ -3665,10 +3762,25 @@ namespace CrossNet.CppRuntime
         public void ParseBinary(IExpression passedExpression, ParsingInfo info)
         {
             IBinaryExpression expression = (IBinaryExpression)passedExpression;
+            if ((expression.Operator == BinaryOperator.IdentityEquality) || (expression.Operator == BinaryOperator.IdentityInequality))
+            {
+                // Comparing a reference with null doesn't make it escape
+                info.NonEscapingUse = IsNullLiteral(expression.Right);
+                ParseExpression(expression.Left, info);
+                info.NonEscapingUse = IsNullLiteral(expression.Left);
+                ParseExpression(expression.Right, info);
+                return;
+            }
             ParseExpression(expression.Left, info);
             ParseExpression(expression.Right, info);
         }
 
+        private static bool IsNullLiteral(IExpression expression)
+        {
+            ILiteralExpression literal = expression as ILiteralExpression;
+            return ((literal != null) && (literal.Value == null));
+        }
+
         public void ParseBlock(IExpression passedExpression, ParsingInfo info)
         {
             IBlockExpression expression = (IBlockExpression)passedExpression;
@@ -3733,6 +3845,8 @@ namespace CrossNet.CppRuntime
         public void ParseFieldReference(IExpression passedExpression, ParsingInfo info)
         {
             IFieldReferenceExpression expression = (IFieldReferenceExpression)passedExpression;
+            // Reading or writing a field doesn't make the target escape
+            info.NonEscapingUse = true;
             ParseExpression(expression.Target, info);
         }
 
@@ -3757,7 +3871,18 @@ namespace CrossNet.CppRuntime
         public void ParseMethodInvoke(IExpression passedExpression, ParsingInfo info)
         {
             IMethodInvokeExpression expression = (IMethodInvokeExpression)passedExpression;
-            ParseExpression(expression.Method, info);
+            IMethodReferenceExpression methodReference = expression.Method as IMethodReferenceExpression;
+            if ((methodReference != null) && IsEscapeAnalysisTarget(methodReference.Target)
+                && CppEscapeAnalysis.IsThisSafe(methodReference.Method))
+            {
+                // The callee doesn't let "this" escape, so the call doesn't make the target escape either
+                info.NonEscapingUse = true;
+                ParseExpression(methodReference.Target, info);
+            }
+            else
+            {
+                ParseExpression(expression.Method, info);
+            }
 
             foreach (IExpression subExpression in expression.Arguments)
             {
@@ -3810,9 +3935,28 @@ namespace CrossNet.CppRuntime
         public void ParsePropertyReference(IExpression passedExpression, ParsingInfo info)
         {
             IPropertyReferenceExpression expression = (IPropertyReferenceExpression)passedExpression;
+            if (IsEscapeAnalysisTarget(expression.Target))
+            {
+                // Same as a method call, the accessors must not let "this" escape
+                // We don't know if the getter or the setter is used, so check both of them
+                IPropertyDeclaration propertyDeclaration = expression.Property.Resolve();
+                if (propertyDeclaration != null)
+                {
+                    bool getterSafe = (propertyDeclaration.GetMethod == null) || CppEscapeAnalysis.IsThisSafe(propertyDeclaration.GetMethod);
+                    bool setterSafe = (propertyDeclaration.SetMethod == null) || CppEscapeAnalysis.IsThisSafe(propertyDeclaration.SetMethod);
+                    info.NonEscapingUse = getterSafe && setterSafe;
+                }
+            }
             ParseExpression(expression.Target, info);
         }
 
+        private static bool IsEscapeAnalysisTarget(IExpression expression)
+        {
+            // Only local variables and "this" are tracked by the escape analysis
+            // No need to analyze the callee for other targets
+            return ((expression is IVariableReferenceExpression) || (expression is IThisReferenceExpression) || (expression is IBaseReferenceExpression));
+        }
+
         public void ParseSizeOf(IExpression passedExpression, ParsingInfo info)
         {
             ISizeOfExpression expression = (ISizeOfExpression)passedExpression;
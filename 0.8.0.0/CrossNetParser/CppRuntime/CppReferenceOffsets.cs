@@ -0,0 +1,150 @@
+/*
+    CrossNet - Copyright (c) 2007 Olivier Nallet
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+    OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Text;
+
+using Reflector;
+using Reflector.CodeModel;
+
+using CrossNet.Common;
+using CrossNet.Interfaces;
+using CrossNet.Net;
+
+namespace CrossNet.CppRuntime
+{
+    // Offsets of the references of a type, used by the GC instead of the virtual __Trace__()
+    //
+    // The offsets are generated as C++ constant expressions (based on offsetof), so the parser doesn't have to know the C++ layout.
+    // The list contains every reference of an instance:
+    //  - The fields of the type and of its base classes (the base class is always at the beginning of the instance).
+    //  - The references of the embedded structs, as the offset of the struct plus the offset of the reference in the struct.
+    //
+    // Like the escape analysis, the answer is conservative: generics, runtime types (implemented in C++, not generated)
+    // and types with events (the event fields are generated differently) don't get any offset list, they keep using __Trace__().
+    //
+    // An empty list means that the type doesn't contain any reference, the GC doesn't look at the instances at all.
+    class CppReferenceOffsets
+    {
+        // Returns null if the references of the type can't be listed
+        public static IList<string> GetReferenceOffsets(ITypeInfo typeInfo)
+        {
+            IList<string> offsets;
+            if (sOffsets.TryGetValue(typeInfo, out offsets) == false)
+            {
+                offsets = new List<string>();
+                if (AddReferenceOffsets(typeInfo, "", offsets) == false)
+                {
+                    offsets = null;
+                }
+                sOffsets[typeInfo] = offsets;
+            }
+            return (offsets);
+        }
+
+        private static bool AddReferenceOffsets(ITypeInfo typeInfo, string prefix, IList<string> offsets)
+        {
+            if ((typeInfo.Type == ObjectType.ENUM) || (typeInfo.IsValueType && typeInfo.IsPrimitiveType))
+            {
+                // No reference in there
+                return (true);
+            }
+            if ((typeInfo.Type != ObjectType.CLASS) && (typeInfo.Type != ObjectType.STRUCT))
+            {
+                return (false);
+            }
+
+            ITypeDeclaration typeDeclaration = typeInfo.TypeDeclaration;
+            if ((typeDeclaration == null) || ((CppTypeGenerator)LanguageManager.TypeGenerator).IsRuntimeType(typeInfo))
+            {
+                // The C++ fields of the runtime types don't match the .Net declaration
+                // Only System.Object is known to not have any reference
+                return (typeInfo.DotNetFullName == OBJECT_TYPE);
+            }
+            if (typeInfo.IsGeneric)
+            {
+                return (false);
+            }
+            if (typeDeclaration.Events.Count != 0)
+            {
+                return (false);
+            }
+
+            if ((typeInfo.IsValueType == false) && (typeInfo.BaseType != null))
+            {
+                // Single inheritance, the base class starts at the beginning of the instance
+                if (AddReferenceOffsets(typeInfo.BaseType, prefix, offsets) == false)
+                {
+                    return (false);
+                }
+            }
+
+            foreach (IFieldDeclaration fieldDeclaration in typeDeclaration.Fields)
+            {
+                if (fieldDeclaration.Static)
+                {
+                    // Traced by the assembly trace
+                    continue;
+                }
+
+                IType fieldType = fieldDeclaration.FieldType;
+                IRequiredModifier requiredModifier = fieldType as IRequiredModifier;
+                if (requiredModifier != null)
+                {
+                    // volatile
+                    fieldType = requiredModifier.ElementType;
+                }
+
+                string fieldName = LanguageManager.NameFixup.UnmangleName(fieldDeclaration.Name);
+                string offset = prefix + "CN_REFERENCE_OFFSET(" + typeInfo.FullName + ", " + fieldName + ")";
+
+                if (fieldType is IArrayType)
+                {
+                    offsets.Add(offset);
+                    continue;
+                }
+                if (fieldType is IPointerType)
+                {
+                    // Unsafe code, __Trace__() doesn't trace those either
+                    continue;
+                }
+
+                ITypeInfo fieldTypeInfo = TypeInfoManager.GetTypeInfo(fieldType);
+                if (fieldTypeInfo == null)
+                {
+                    // Generic argument or unknown type...
+                    return (false);
+                }
+                if (fieldTypeInfo.IsValueType)
+                {
+                    if (AddReferenceOffsets(fieldTypeInfo, offset + " + ", offsets) == false)
+                    {
+                        return (false);
+                    }
+                }
+                else
+                {
+                    offsets.Add(offset);
+                }
+            }
+            return (true);
+        }
+
+        private const string OBJECT_TYPE = "System.Object";
+        private static IDictionary<ITypeInfo, IList<string>> sOffsets = new Dictionary<ITypeInfo, IList<string>>();
+    }
+}
@@ -40,7 +40,12 @@ namespace CrossNet.CppRuntime
             // First do a pre-parsing...
             // The pre-parsing is used to detect incorrect label and generate correctly anonymous methods
             // It parses statements and expressions recursively
+            info.ThisEscapes = false;
             ParseStatement(statement, info);
+            CppEscapeAnalysis.OnBodyParsed(statement, info);
+
+            // The pre-parsing also collected the objects that never escape the method, they will be created on the stack
+            info.ResolveStackAllocations();
 
             // All the variables that have been used by anonymous method must be transformed
             StringData anonymousVariables = FixupVariableName(info);
@@ -50,6 +55,7 @@ namespace CrossNet.CppRuntime
 
             // We don't want these variables to pollute another method
             info.ClearAnonymousVariables();
+            info.ClearStackAllocations();
             info.AtLeastOneAnonymousMethod = false;
 
             if (anonymousVariables != null)
@@ -562,7 +568,52 @@ namespace CrossNet.CppRuntime
             // But first we have to look if the class implements the method publicly
             // If it does that mean that it takes priority over everything else...
             IMethodDeclaration getEnumeratorMethod = null;
-            if (inInfo != null)
+            if (LanguageManager.LocalTypeManager.TypeString.Same(inData.LocalType))
+            {
+                // Same thing for the strings, the characters are read directly without creating a CharEnumerator
+                // The string is kept in a local variable (and not only its buffer), so it can't be collected during the loop
+                string tempVariableString = CppUtil.GetNextTempVariable();
+                data.Append("::System::String * " + tempVariableString + " = ");
+                data.AppendSameLine(inData);
+                data.AppendSameLine(";\n");
+
+                string tempVariableLength = CppUtil.GetNextTempVariable();
+                data.Append("::System::Int32 " + tempVariableLength + " = ");
+                data.AppendSameLine(tempVariableString + "->get_Length();\n");
+
+                string tempVariableIndex = CppUtil.GetNextTempVariable();
+                data.Append("for (");
+                data.AppendSameLine("::System::Int32 " + tempVariableIndex + " = 0 ; ");
+                data.AppendSameLine(tempVariableIndex + " < " + tempVariableLength + " ; ");
+                data.AppendSameLine("++" + tempVariableIndex + ")\n");
+
+                data.Append("{\n");
+                data.Indentation++;
+
+                data.Append(variableDeclaration);
+                string getItemCall = tempVariableString + "->get_Item(" + tempVariableIndex + ")";
+                string needCast = LanguageManager.LocalTypeManager.DoesNeedCast(variableDeclaration.LocalType, LanguageManager.LocalTypeManager.TypeChar);
+                if (needCast != "")
+                {
+                    data.AppendSameLine(" = " + needCast + "(" + getItemCall + ");\n");
+                }
+                else
+                {
+                    data.AppendSameLine(" = " + getItemCall + ";\n");
+                }
+
+                data.Append(GenerateCode(forEachStatement.Body, info));
+
+                data.Indentation--;
+                data.Append("}\n");
+
+                data.Indentation--;
+                data.Append("}\n");
+
+                info.AddStatementState(backupState);
+                return (data);
+            }
+            else if (inInfo != null)
             {
                 getEnumeratorMethod = Util.FindMethod(inInfo, "GetEnumerator", null, null, false);
                 Debug.Assert(getEnumeratorMethod != null);
@@ -602,9 +653,11 @@ namespace CrossNet.CppRuntime
                     data.AppendSameLine(inData);
                     data.AppendSameLine(";\n");
 
+                    // Use the non-virtual accessors, the length is read only once
+                    // SingleDimensionItem() also works for multi-dimensional arrays (foreach goes through every item)
                     string tempVariableLength = CppUtil.GetNextTempVariable();
                     data.Append("::System::Int32 " + tempVariableLength + " = ");
-                    data.AppendSameLine(tempVariableArray + "->get_Length();\n");
+                    data.AppendSameLine(tempVariableArray + "->__GetNumItems__();\n");
 
                     string tempVariableIndex = CppUtil.GetNextTempVariable();
                     data.Append("for (");
@@ -616,7 +669,7 @@ namespace CrossNet.CppRuntime
                     data.Indentation++;
 
                     data.Append(variableDeclaration);
-                    data.AppendSameLine(" = " + tempVariableArray + "->Item(" + tempVariableIndex + ");\n");
+                    data.AppendSameLine(" = " + tempVariableArray + "->SingleDimensionItem(" + tempVariableIndex + ");\n");
 
                     data.Append(GenerateCode(forEachStatement.Body, info));
 
@@ -679,6 +732,7 @@ namespace CrossNet.CppRuntime
             bool isBase = (forEachStatement.Expression is IBaseReferenceExpression);
 
             string tempVariable;    // Don't initialize it yet, so the order stays consistent
+            string tempEnumerable = null;
 
             if (enumerableInterface)
             {
@@ -693,7 +747,7 @@ namespace CrossNet.CppRuntime
                 enumerableInstance = enumerableType + inInfo.GetInstancePostFix();
                 localType = inInfo.LocalType;
 
-                string tempEnumerable = CppUtil.GetNextTempVariable();
+                tempEnumerable = CppUtil.GetNextTempVariable();
                 data.Append(enumerableInstance);
                 data.AppendSameLine(" " + tempEnumerable + " = ");
                 // We might need a cast between the target type and the temporary interface type
@@ -731,6 +785,32 @@ namespace CrossNet.CppRuntime
                 data.AppendSameLine("GetEnumerator();\n");
             }
 
+            // Like C#, dispose the enumerator (not the enumerable) when the loop is left
+            bool disposeAfterLoop = false;
+            ITypeInfo disposeInfo = LanguageManager.LocalTypeManager.TypeIDisposable.GetTypeInfo();
+            if ((disposeInfo != null) && Util.CanImplicitCast(enumeratorInfo, disposeInfo))
+            {
+                if (enumeratorInfo.Type == ObjectType.INTERFACE)
+                {
+                    // Typically IEnumerator<T>, the enumerator can be anything
+                    // The scope disposes it even if the loop is left with return, break or goto (like the C# finally).
+                    // This is also what gives the runtime enumerators back to their pool (see CrossNetRuntime::ForEachScope),
+                    // only when the enumerable is known, as the enumerator can't be referenced anywhere else then.
+                    string enumerableParameter = (tempEnumerable != null) ? tempEnumerable : "NULL";
+                    data.Append("::CrossNetRuntime::ForEachScope " + CppUtil.GetNextTempVariable() + "(" + enumerableParameter + ", " + tempVariable + ");\n");
+                }
+                else
+                {
+                    disposeAfterLoop = true;
+                }
+            }
+            else
+            {
+                // If disposeInfo is null, it means that System.IDisposable has not been parsed yet
+                // In reality this is not an issue as if the type was deriving from System::IDisposable
+                // the interface would have been parsed as well... So it also means it's not implementing the interface
+            }
+
             string tempVariableMoveNext;
             string tempVariableGetCurrent;
             ITypeInfo enumeratorInfoMoveNext = null;
@@ -771,16 +851,27 @@ namespace CrossNet.CppRuntime
                 enumeratorInfoGetCurrent = enumeratorInfo;
             }
 
-            // TODO: To speed up the foreach a little bit more
-            //  It seems that if enumeratorInfoMoveNext or enumeratorInfoGetCurrent are interfaces
-            //  We could actually cache the interface map pointer, the interface wrapper or even better possibly the corresponding function pointer.
-            //  That way, we would just do a static call instead of a slower interface call!
+            // The enumerator doesn't change during the loop, so if MoveNext() and get_Current() are interface calls
+            // the interface wrappers are looked up only once before the loop, the loop itself calls the wrappers directly.
+            string wrapperMoveNext = null;
+            if (enumeratorInfoMoveNext.Type == ObjectType.INTERFACE)
+            {
+                wrapperMoveNext = CppUtil.GetNextTempVariable();
+                data.Append(enumeratorInfoMoveNext.FullName + " * " + wrapperMoveNext + " = ");
+                data.AppendSameLine(CppUtil.InterfaceCall(tempVariableMoveNext, enumeratorInfoMoveNext.FullName) + ";\n");
+            }
+            string wrapperGetCurrent = null;
+            if (enumeratorInfoGetCurrent.Type == ObjectType.INTERFACE)
+            {
+                wrapperGetCurrent = CppUtil.GetNextTempVariable();
+                data.Append(enumeratorInfoGetCurrent.FullName + " * " + wrapperGetCurrent + " = ");
+                data.AppendSameLine(CppUtil.InterfaceCall(tempVariableGetCurrent, enumeratorInfoGetCurrent.FullName) + ";\n");
+            }
 
             // MoveNext() already using a temp variable, no need to combine statements...
             if (enumeratorInfoMoveNext.Type == ObjectType.INTERFACE)
             {
-                string moveNextCall = CppUtil.InterfaceCall(tempVariableMoveNext, enumeratorInfoMoveNext.FullName, "MoveNext");
-                data.Append("while (" + moveNextCall + ")\n");
+                data.Append("while (" + wrapperMoveNext + "->MoveNext(" + tempVariableMoveNext + "))\n");
             }
             else
             {
@@ -800,7 +891,7 @@ namespace CrossNet.CppRuntime
             string getCurrentCall;
             if (enumeratorInfoGetCurrent.Type == ObjectType.INTERFACE)
             {
-                getCurrentCall = CppUtil.InterfaceCall(tempVariableGetCurrent, enumeratorInfoGetCurrent.FullName, "get_Current");
+                getCurrentCall = wrapperGetCurrent + "->get_Current(" + tempVariableGetCurrent + ")";
             }
             else
             {
@@ -820,28 +911,12 @@ namespace CrossNet.CppRuntime
             data.Indentation--;
             data.Append("}\n");
 
+            if (disposeAfterLoop)
             {
                 // Dispose() already using a temp variable, no need to combine statements...
-                ITypeInfo disposeInfo = LanguageManager.LocalTypeManager.TypeIDisposable.GetTypeInfo();
-                if (disposeInfo != null)
-                {
-                    if ((inInfo != null) && Util.CanImplicitCast(inInfo, disposeInfo))
-                    {
-                        // TODO: This might not be correct if one of the base class is actually a disposable
-                        // The sub class won't have the method. And BTW this should be an interface call...
-
-                        //      data.Append(CppUtil.InterfaceCall(tempVariable, "System::IDisposable", "Dispose"));
-                        // might be more correct...
-
-                        data.Append(tempVariable + enumeratorInfo.PointerToMember + "Dispose();\n");
-                    }
-                }
-                else
-                {
-                    // Here it means that System.IDisposable has not been parsed yet
-                    // In reality this is not an issue as if the type was deriving from System::IDisposable
-                    // the interface would have been parsed as well... So it also means it's not implementing the interface
-                }
+                // TODO: This might not be correct if one of the base class is actually a disposable
+                // The sub class won't have the method...
+                data.Append(tempVariable + enumeratorInfo.PointerToMember + "Dispose();\n");
             }
 
             data.Indentation--;
@@ -1071,18 +1146,16 @@ namespace CrossNet.CppRuntime
             // Push the value type on the stack
             info.CurrentSwitch.Push(switchValue.LocalType);
 
-            data.AppendSameLine(switchValue);
             if (LanguageManager.LocalTypeManager.TypeString.Same(switchValue.LocalType))
             {
                 // This is a special case here... Switch case on strings...
-                // We are actually comparing hashcode ;)
-                // There is potentially a risk of collision but we will improve that later...
-
-                // Also we fully qualify the type (because we know it is a string)
-                // The reason is two folds: We do a static call instead of a virtual call, so it is faster
-                // But mainly by _not_ having a virtual call, the test is still valid even with null string.
-                data.AppendSameLine("->::System::String::GetHashCode()");
+                data = GenerateCodeStringSwitch(switchStatement, switchValue, info);
+                info.CurrentSwitch.Pop();
+                info.AddStatementState(backupState);
+                return (data);
             }
+
+            data.AppendSameLine(switchValue);
             data.AppendSameLine(")\n");
             data.Append("{\n");
             ++data.Indentation;
@@ -1110,6 +1183,93 @@ namespace CrossNet.CppRuntime
             return (data);
         }
 
+        private StringData GenerateCodeStringSwitch(ISwitchStatement switchStatement, StringData switchValue, ParsingInfo info)
+        {
+            // See CppStringSwitch for the details, the cases are numbered in order
+            // The first part finds the case index, the second part is a switch on the index with the original bodies
+            CppStringSwitch stringSwitch = new CppStringSwitch();
+            StringData bodies = new StringData();
+            int caseIndex = 0;
+            foreach (ISwitchCase switchCase in switchStatement.Cases)
+            {
+                if (switchCase is IDefaultCase)
+                {
+                    bodies.Append("default:\n");
+                }
+                else
+                {
+                    IConditionCase conditionCase = (IConditionCase)switchCase;
+                    List<string> comments = new List<string>();
+                    GenerateCodeStringCase(conditionCase.Condition, stringSwitch, caseIndex, comments, info);
+                    bodies.Append("case " + caseIndex + ":\t\t// " + String.Join(", ", comments.ToArray()) + "\n");
+                    ++caseIndex;
+                }
+
+                bodies.Append(GenerateCode(switchCase.Body, info));
+            }
+
+            // We fully qualify the calls (because we know it is a string)
+            // So they are static calls instead of virtual calls, and they are still valid with a null string
+            string valueVariable = CppUtil.GetNextTempVariable();
+            string indexVariable = CppUtil.GetNextTempVariable();
+            StringData data = new StringData("{\n");
+            ++data.Indentation;
+            data.Append("::System::String * " + valueVariable + " = ");
+            data.AppendSameLine(switchValue);
+            data.AppendSameLine(";\n");
+            data.Append("::System::Int32 " + indexVariable + " = -1;\n");
+            data.Append(stringSwitch.GenerateCode(valueVariable, indexVariable));
+            data.Append("switch (" + indexVariable + ")\n");
+            data.Append("{\n");
+            data.Append(1, bodies);
+            data.Append("}\n");
+            --data.Indentation;
+            data.Append("}\n");
+            return (data);
+        }
+
+        private void GenerateCodeStringCase(IExpression expression, CppStringSwitch stringSwitch, int caseIndex, List<string> comments, ParsingInfo info)
+        {
+            IBinaryExpression caseExpression = expression as IBinaryExpression;
+            if ((caseExpression != null) && (caseExpression.Operator == BinaryOperator.BooleanOr))
+            {
+                // Several contiguous cases are actually a "||" of the cases
+                GenerateCodeStringCase(caseExpression.Left, stringSwitch, caseIndex, comments, info);
+                GenerateCodeStringCase(caseExpression.Right, stringSwitch, caseIndex, comments, info);
+                return;
+            }
+
+            ILiteralExpression literal = expression as ILiteralExpression;
+            if (literal != null)
+            {
+                // For the case on strings, we need the original string (esp. without esc. sequence...)
+                string text = literal.Value as String;
+                if (text != null)
+                {
+                    stringSwitch.AddString(text, caseIndex);
+                    comments.Add(CppStringSwitch.GetComment(text));
+                    return;
+                }
+                if (literal.Value == null)
+                {
+                    stringSwitch.AddNull(caseIndex);
+                    comments.Add(CppStringSwitch.GetComment(null));
+                    return;
+                }
+            }
+
+            StringData caseData = LanguageManager.ExpressionGenerator.GenerateCode(expression, info);
+            if (caseData.Text == "::System::String::Empty")
+            {
+                stringSwitch.AddString("", caseIndex);
+                comments.Add(CppStringSwitch.GetComment(""));
+                return;
+            }
+            // Not a constant we know, it will be compared after the dispatch
+            stringSwitch.AddExpression(caseData.Text, caseIndex);
+            comments.Add(caseData.Text);
+        }
+
         private void GenerateCodeCase(IExpression expression, StringData data, ParsingInfo info)
         {
             IBinaryExpression caseExpression = expression as IBinaryExpression;
@@ -1126,49 +1286,11 @@ namespace CrossNet.CppRuntime
             info.InCase = true;
             StringData caseData = LanguageManager.ExpressionGenerator.GenerateCode(expression, info);
             info.InCase = false;
-            if (LanguageManager.LocalTypeManager.TypeString.Same(caseData.LocalType))
+            // Switch on strings are handled by GenerateCodeStringCase()
+            if (LanguageManager.LocalTypeManager.TypeNull.Same(caseData.LocalType))
             {
-                // In case of switch case with strings, we are currently using hashcode...
-#if DISABLED    // String pool changed this behavior
-                const string NEW_STRING_START = "::System::String::__Create__(L";
-                const string NEW_STRING_END = ")";
-                if (caseData.Text.StartsWith(NEW_STRING_START) && (caseData.Text.EndsWith(NEW_STRING_END)))
-                {
-                    string text = caseData.Text;
-                    text = text.Substring(NEW_STRING_START.Length, text.Length - (NEW_STRING_START.Length + NEW_STRING_END.Length));
-                    caseData.Replace(text);
-                }
-#else
-                if (expression is ILiteralExpression)
-                {
-                    // For the case on strings, we still need the original string (esp. without esc. sequence...)
-                    ILiteralExpression literal = (ILiteralExpression)expression;
-                    caseData.Replace(literal.Value as String);
-                }
-#endif
-
-                if (caseData.Text == "::System::String::Empty")
-                {
-                    caseData.Replace("\"\"");
-                }
-                Int32 hashCode = CppUtil.GetStringHashCode(caseData.Text);
-                data.AppendSameLine(hashCode.ToString());
-                data.AppendSameLine(":");
-                // For debugging reason, put the string in comment... 
-                data.AppendSameLine("\t\t// " + caseData.Text);
-                data.AppendSameLine("\n");
-            }
-            else if (LanguageManager.LocalTypeManager.TypeNull.Same(caseData.LocalType))
-            {
-                // For null pointer - it should be used only for strings - maybe for nullable objects as well
-                // We use the hash-code 0
-                // By definition nothing should use the hashcode 0 (at least for strings, might have to adapt for nullable)
-                // So if the string pointer is null, it "kind of" make sense to use 0
-                // At least we differentiate it from the other strings.
-                // The reason why 0 can't be used is because the hashcode is cached in the string code
-                // (as they are immutable and should be pooled as well...)
-                // And 0 indicates that the string hash code has not been calculated yet.
-                // Enabling the usage of 0 would mean in those very rare strings that the cache would not work
+                // For null pointer - the strings don't come here anymore, maybe for nullable objects
+                // We use 0 like before
                 data.AppendSameLine("0:");
                 data.AppendSameLine("\t\t// null");
                 data.AppendSameLine("\n");
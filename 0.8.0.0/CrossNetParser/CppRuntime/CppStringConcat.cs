@@ -0,0 +1,243 @@
+/*
+    CrossNet - Copyright (c) 2007 Olivier Nallet
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+    OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Text;
+
+using Reflector;
+using Reflector.CodeModel;
+
+using CrossNet.Common;
+using CrossNet.Interfaces;
+using CrossNet.Net;
+
+
+namespace CrossNet.CppRuntime
+{
+    // Flattening of the string concatenations
+    //
+    // The C# compiler generates String.Concat() calls (with an array when there are more than 4 parts),
+    // and the concatenations can be nested. The whole chain is flattened in a single CrossNetRuntime::StringConcat
+    // that allocates the result only once. Consecutive literals are merged at parsing time and stored in the string pool.
+    //
+    // Concatenations that can't be flattened (like String.Concat() with an existing array) are left as is.
+    class CppStringConcat
+    {
+        // Returns null if the expression is not a concatenation that can be flattened
+        public static StringData GenerateCode(IMethodInvokeExpression expression, ParsingInfo info)
+        {
+            if (CanFlatten(expression) == false)
+            {
+                return (null);
+            }
+
+            List<Part> parts = new List<Part>();
+            AddParts(expression, parts, info);
+
+            // Merge the consecutive literals
+            List<Part> mergedParts = new List<Part>();
+            foreach (Part part in parts)
+            {
+                int last = mergedParts.Count - 1;
+                if ((part.Literal != null) && (last >= 0) && (mergedParts[last].Literal != null))
+                {
+                    mergedParts[last] = new Part(mergedParts[last].Literal + part.Literal);
+                }
+                else
+                {
+                    mergedParts.Add(part);
+                }
+            }
+            mergedParts.RemoveAll(IsEmptyLiteral);
+
+            StringData data;
+            if (mergedParts.Count == 0)
+            {
+                data = new StringData("::System::String::Empty");
+            }
+            else if ((mergedParts.Count == 1) && (mergedParts[0].Literal != null))
+            {
+                // The whole concatenation is known at parsing time
+                data = new StringData(StringPool.CreateString(mergedParts[0].Literal));
+            }
+            else
+            {
+                data = new StringData("::CrossNetRuntime::StringConcat< " + mergedParts.Count + " >()");
+                foreach (Part part in mergedParts)
+                {
+                    if (part.Literal != null)
+                    {
+                        data.AppendSameLine(".Add(" + StringPool.CreateString(part.Literal) + ")");
+                    }
+                    else
+                    {
+                        data.AppendSameLine(part.Code);
+                    }
+                }
+                data.AppendSameLine(".ToString()");
+            }
+            data.LocalType = LanguageManager.LocalTypeManager.TypeString;
+            return (data);
+        }
+
+        private static bool IsConcat(IMethodInvokeExpression expression)
+        {
+            IMethodReferenceExpression methodReferenceExpression = expression.Method as IMethodReferenceExpression;
+            if (methodReferenceExpression == null)
+            {
+                return (false);
+            }
+            IMethodReference methodReference = methodReferenceExpression.Method;
+            if ((methodReference == null) || (methodReference.Name != CONCAT) || (methodReference.HasThis))
+            {
+                return (false);
+            }
+            ITypeInfo declaringType = TypeInfoManager.GetTypeInfo(methodReference.DeclaringType);
+            return ((declaringType != null) && (declaringType.DotNetFullName == STRING_TYPE));
+        }
+
+        private static bool CanFlatten(IMethodInvokeExpression expression)
+        {
+            if (IsConcat(expression) == false)
+            {
+                return (false);
+            }
+            if (expression.Arguments.Count >= 2)
+            {
+                return (true);
+            }
+            if (expression.Arguments.Count == 1)
+            {
+                // String.Concat(new String[] { ... }) or String.Concat(new Object[] { ... })
+                IMethodReference methodReference = ((IMethodReferenceExpression)expression.Method).Method;
+                IArrayCreateExpression arrayCreate = expression.Arguments[0] as IArrayCreateExpression;
+                return ((methodReference.Parameters[0].ParameterType is IArrayType)
+                    && (arrayCreate != null) && (arrayCreate.Initializer != null) && (arrayCreate.Dimensions.Count == 1));
+            }
+            return (false);
+        }
+
+        private static void AddParts(IMethodInvokeExpression expression, List<Part> parts, ParsingInfo info)
+        {
+            IMethodReference methodReference = ((IMethodReferenceExpression)expression.Method).Method;
+            if (expression.Arguments.Count == 1)
+            {
+                IArrayCreateExpression arrayCreate = (IArrayCreateExpression)expression.Arguments[0];
+                IType elementType = ((IArrayType)methodReference.Parameters[0].ParameterType).ElementType;
+                foreach (IExpression argument in arrayCreate.Initializer.Expressions)
+                {
+                    AddPart(argument, elementType, parts, info);
+                }
+            }
+            else
+            {
+                int index = 0;
+                foreach (IExpression argument in expression.Arguments)
+                {
+                    AddPart(argument, methodReference.Parameters[index].ParameterType, parts, info);
+                    ++index;
+                }
+            }
+        }
+
+        private static void AddPart(IExpression argument, IType parameterType, List<Part> parts, ParsingInfo info)
+        {
+            IMethodInvokeExpression nestedConcat = argument as IMethodInvokeExpression;
+            if ((nestedConcat != null) && CanFlatten(nestedConcat))
+            {
+                AddParts(nestedConcat, parts, info);
+                return;
+            }
+
+            ILiteralExpression literal = argument as ILiteralExpression;
+            if (literal != null)
+            {
+                if (literal.Value == null)
+                {
+                    // null is concatenated as an empty string
+                    return;
+                }
+                string text = literal.Value as String;
+                if (text != null)
+                {
+                    parts.Add(new Part(text));
+                    return;
+                }
+            }
+
+            StringData code = LanguageManager.ExpressionGenerator.GenerateCode(argument, info);
+            if (code.Text == "::System::String::Empty")
+            {
+                parts.Add(new Part(""));
+                return;
+            }
+
+            StringData part;
+            if (LanguageManager.LocalTypeManager.TypeString.Same(code.LocalType))
+            {
+                part = new StringData(".Add(");
+                part.AppendSameLine(code);
+            }
+            else
+            {
+                // Any other type is converted like for the String.Concat(Object...) parameter
+                LocalType destinationType = LanguageManager.ReferenceGenerator.GenerateCodeType(parameterType, info).LocalType;
+                string cast = LanguageManager.LocalTypeManager.DoesNeedCast(destinationType, code.LocalType);
+                part = new StringData(".AddObject(" + cast);
+                if (cast != "")
+                {
+                    part.AppendSameLine("(");
+                    part.AppendSameLine(code);
+                    part.AppendSameLine(")");
+                }
+                else
+                {
+                    part.AppendSameLine(code);
+                }
+            }
+            part.AppendSameLine(")");
+            parts.Add(new Part(part));
+        }
+
+        private static bool IsEmptyLiteral(Part part)
+        {
+            return (part.Literal == "");
+        }
+
+        private struct Part
+        {
+            public Part(string literal)
+            {
+                Literal = literal;
+                Code = null;
+            }
+
+            public Part(StringData code)
+            {
+                Literal = null;
+                Code = code;
+            }
+
+            // Only one of them is set
+            public string Literal;
+            public StringData Code;
+        }
+
+        private const string CONCAT = "Concat";
+        private const string STRING_TYPE = "System.String";
+    }
+}
@@ -0,0 +1,220 @@
+/*
+    CrossNet - Copyright (c) 2007 Olivier Nallet
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+    OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Text;
+
+using CrossNet.Common;
+
+namespace CrossNet.CppRuntime
+{
+    // Lowering of the switch on strings
+    //
+    // The switch is split in two parts:
+    //  - First the index of the matching case is found, without calculating the hash code of the string.
+    //    The generated code dispatches on the length of the string, then on the characters that are different
+    //    between the labels of the same length (a decision tree built at parsing time, so it is collision free).
+    //    The selected label is compared to the string when the dispatch didn't already test every character.
+    //  - Then a regular switch on that index contains the original case bodies, so break and default behave as in C#.
+    // A string that doesn't match any label (or a null string without "case null") gets the index -1 and goes to default.
+    class CppStringSwitch
+    {
+        public void AddString(string text, int caseIndex)
+        {
+            mStrings.Add(new Label(text, caseIndex));
+        }
+
+        public void AddNull(int caseIndex)
+        {
+            mNullCaseIndex = caseIndex;
+        }
+
+        // Label that is not a constant known at parsing time, it is compared after the dispatch
+        public void AddExpression(string expression, int caseIndex)
+        {
+            mExpressions.Add(new Label(expression, caseIndex));
+        }
+
+        // Generates the code setting indexVariable from the string stored in valueVariable
+        // indexVariable must be initialized to -1 beforehand
+        public StringData GenerateCode(string valueVariable, string indexVariable)
+        {
+            StringData data = new StringData();
+            if (mNullCaseIndex != NO_CASE)
+            {
+                data.Append("if (" + valueVariable + " == NULL)\n");
+                data.Append("{\n");
+                data.Append(1, indexVariable + " = " + mNullCaseIndex + ";\n");
+                data.Append("}\n");
+                data.Append("else\n");
+            }
+            else
+            {
+                data.Append("if (" + valueVariable + " != NULL)\n");
+            }
+            data.Append("{\n");
+            ++data.Indentation;
+
+            if (mStrings.Count != 0)
+            {
+                SortedDictionary<int, List<Label>> labelsPerLength = new SortedDictionary<int, List<Label>>();
+                foreach (Label label in mStrings)
+                {
+                    List<Label> labels;
+                    if (labelsPerLength.TryGetValue(label.Text.Length, out labels) == false)
+                    {
+                        labels = new List<Label>();
+                        labelsPerLength.Add(label.Text.Length, labels);
+                    }
+                    labels.Add(label);
+                }
+
+                data.Append("switch (" + valueVariable + "->get_Length())\n");
+                data.Append("{\n");
+                ++data.Indentation;
+                foreach (KeyValuePair<int, List<Label>> pair in labelsPerLength)
+                {
+                    data.Append("case " + pair.Key + ":\n");
+                    ++data.Indentation;
+                    GenerateCodeDispatch(pair.Value, new bool[pair.Key], valueVariable, indexVariable, data);
+                    data.Append("break;\n");
+                    --data.Indentation;
+                }
+                --data.Indentation;
+                data.Append("}\n");
+            }
+
+            foreach (Label label in mExpressions)
+            {
+                data.Append("if ((" + indexVariable + " == -1) && ::System::String::op_Equality(" + valueVariable + ", " + label.Text + "))\n");
+                data.Append("{\n");
+                data.Append(1, indexVariable + " = " + label.CaseIndex + ";\n");
+                data.Append("}\n");
+            }
+
+            --data.Indentation;
+            data.Append("}\n");
+            return (data);
+        }
+
+        // Text put in comment to help debugging the generated code
+        public static string GetComment(string text)
+        {
+            if (text == null)
+            {
+                return ("null");
+            }
+            StringBuilder comment = new StringBuilder("\"");
+            foreach (char c in text)
+            {
+                // Don't let a new line (or anything unusual) break the comment
+                comment.Append(((c < ' ') || (c > '~')) ? '?' : c);
+            }
+            comment.Append('"');
+            return (comment.ToString());
+        }
+
+        // All the labels have the same length, tested is the list of characters already known at this point
+        private static void GenerateCodeDispatch(List<Label> labels, bool[] tested, string valueVariable, string indexVariable, StringData data)
+        {
+            if (labels.Count == 1)
+            {
+                Label label = labels[0];
+                if (Array.IndexOf(tested, false) < 0)
+                {
+                    // Every single character has been tested, this is the label
+                    data.Append(indexVariable + " = " + label.CaseIndex + ";\t\t// " + GetComment(label.Text) + "\n");
+                    return;
+                }
+                data.Append("if (::System::String::op_Equality(" + valueVariable + ", " + StringPool.CreateString(label.Text) + "))\n");
+                data.Append("{\n");
+                data.Append(1, indexVariable + " = " + label.CaseIndex + ";\t\t// " + GetComment(label.Text) + "\n");
+                data.Append("}\n");
+                return;
+            }
+
+            // Use the character that splits the labels the most
+            // As the labels are all different, there is always one with at least two different values
+            int position = -1;
+            int bestCount = 0;
+            for (int i = 0; i < tested.Length; ++i)
+            {
+                if (tested[i])
+                {
+                    continue;
+                }
+                int count = GetLabelsPerChar(labels, i).Count;
+                if (count > bestCount)
+                {
+                    position = i;
+                    bestCount = count;
+                }
+            }
+            Debug.Assert(bestCount >= 2);
+
+            tested[position] = true;
+            data.Append("switch (" + valueVariable + "->__ToCString__()[" + position + "])\n");
+            data.Append("{\n");
+            ++data.Indentation;
+            foreach (KeyValuePair<char, List<Label>> pair in GetLabelsPerChar(labels, position))
+            {
+                data.Append("case " + (int)pair.Key + ":\n");
+                ++data.Indentation;
+                GenerateCodeDispatch(pair.Value, tested, valueVariable, indexVariable, data);
+                data.Append("break;\n");
+                --data.Indentation;
+            }
+            --data.Indentation;
+            data.Append("}\n");
+            tested[position] = false;
+        }
+
+        private static SortedDictionary<char, List<Label>> GetLabelsPerChar(List<Label> labels, int position)
+        {
+            SortedDictionary<char, List<Label>> labelsPerChar = new SortedDictionary<char, List<Label>>();
+            foreach (Label label in labels)
+            {
+                List<Label> sameChar;
+                char c = label.Text[position];
+                if (labelsPerChar.TryGetValue(c, out sameChar) == false)
+                {
+                    sameChar = new List<Label>();
+                    labelsPerChar.Add(c, sameChar);
+                }
+                sameChar.Add(label);
+            }
+            return (labelsPerChar);
+        }
+
+        private struct Label
+        {
+            public Label(string text, int caseIndex)
+            {
+                Text = text;
+                CaseIndex = caseIndex;
+            }
+
+            public string Text;
+            public int CaseIndex;
+        }
+
+        private const int NO_CASE = -1;
+        private List<Label> mStrings = new List<Label>();
+        private List<Label> mExpressions = new List<Label>();
+        private int mNullCaseIndex = NO_CASE;
+    }
+}
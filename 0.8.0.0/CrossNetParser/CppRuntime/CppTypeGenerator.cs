@@ -53,6 +53,13 @@ namespace CrossNet.CppRuntime
             mStaticConstructorList.Clear();
             mInterfaceWrapperList.Clear();
             mAssemblyTrace.Clear();
+            mReferenceOffsetsTraits.Clear();
+
+            // The static ids continue from one assembly to the next so they never collide within the same parsing
+            mUseStaticIds = (assemblyData.FirstStaticId > 0);
+            mNextStaticInterfaceId = Math.Max(mNextStaticInterfaceId, assemblyData.FirstStaticId);
+            // 0 and -1 are reserved for System::Object and System::ValueType
+            mNextStaticObjectId = Math.Min(mNextStaticObjectId, -assemblyData.FirstStaticId - 1);
 
             GeneratedData   generatedData = new GeneratedData();
             mClassDeclarationData = new StringData();
@@ -198,6 +205,7 @@ namespace CrossNet.CppRuntime
                 mClassDefinitionData.Append(mIncludesData);
             }
 
+            GenerateReferenceOffsetsTraits(assemblyData);
             GenerateStaticConstructorCalls(safeOutputAssemblyName, assemblyData);
             GenerateInterfaceMaps(safeOutputAssemblyName, assemblyData);
             GenerateAssemblyTrace(safeOutputAssemblyName, assemblyData);
@@ -239,6 +247,37 @@ namespace CrossNet.CppRuntime
             mMethodDefinitionData.Append("}\n");
         }
 
+        private void GenerateReferenceOffsetsTraits(AssemblyData assemblyData)
+        {
+            if (mReferenceOffsetsTraits.Count == 0)
+            {
+                return;
+            }
+
+            // The traits have to be specialized in the runtime namespace
+            mClassDefinitionData.Append("namespace CrossNetRuntime\n");
+            mClassDefinitionData.Append("{\n");
+            mClassDefinitionData.Indentation++;
+
+            foreach (StringTypeInfo oneTrait in mReferenceOffsetsTraits)
+            {
+                if (assemblyData.Mode == OutputMode.TwoFilesPerClass)
+                {
+                    string define = GetCrossNetDefine(oneTrait.TypeInfo);
+                    mClassDefinitionData.Append("#ifndef " + define + "\n");
+                    mClassDefinitionData.Append(oneTrait.Text + "\n");
+                    mClassDefinitionData.Append("#endif\n");
+                }
+                else
+                {
+                    mClassDefinitionData.Append(oneTrait.Text + "\n");
+                }
+            }
+
+            mClassDefinitionData.Indentation--;
+            mClassDefinitionData.Append("}\n");
+        }
+
         private void GenerateStaticConstructorCalls(string outputAssemblyName, AssemblyData assemblyData)
         {
             // Note: That this function is outside any namespace and is global
@@ -521,13 +560,7 @@ namespace CrossNet.CppRuntime
         {
             ITypeInfo typeInfo = TypeInfoManager.GetTypeInfo(typeDeclaration);
 
-            string typeName = typeInfo.DotNetFullName;
-            if (typeInfo.NumGenericArguments != 0)
-            {
-                typeName += "`" + typeInfo.NumGenericArguments.ToString();
-            }
-
-            if (mDontGenerateTypes.ContainsKey(typeName))
+            if (IsRuntimeType(typeInfo))
             {
                 // This type should not be included...
                 return (typeInfo);
@@ -544,6 +577,17 @@ namespace CrossNet.CppRuntime
             return (typeInfo);
         }
 
+        // True if the type is implemented by the runtime instead of being generated (like System::String)
+        public bool IsRuntimeType(ITypeInfo typeInfo)
+        {
+            string typeName = typeInfo.DotNetFullName;
+            if (typeInfo.NumGenericArguments != 0)
+            {
+                typeName += "`" + typeInfo.NumGenericArguments.ToString();
+            }
+            return (mDontGenerateTypes.ContainsKey(typeName));
+        }
+
         public void GenerateCode(ITypeInfo typeInfo, NestedType nested, AssemblyData assemblyData)
         {
             int numNamespaces = 0;
@@ -838,7 +882,7 @@ namespace CrossNet.CppRuntime
                 }
                 else
                 {
-                    mClassDefinitionData.Append("CN_DYNAMIC_ID()\n");
+                    mClassDefinitionData.Append(GetIdMacro(typeInfo));
                 }
             }
 
@@ -1162,6 +1206,36 @@ namespace CrossNet.CppRuntime
             mMethodDefinitionData.Indentation--;
             mMethodDefinitionData.Append("}\n");
 
+            // When possible, list the references as well, the GC uses them instead of calling __Trace__()
+            IList<string> referenceOffsets = null;
+            if ((typeDeclaration.GenericArguments.Count == 0) && ((objectType == ObjectType.CLASS) || (objectType == ObjectType.STRUCT)))
+            {
+                referenceOffsets = CppReferenceOffsets.GetReferenceOffsets(typeInfo);
+            }
+            if (referenceOffsets != null)
+            {
+                mClassDefinitionData.Append("static const ::CrossNetRuntime::ReferenceOffset s__ReferenceOffsets__[];\n");
+
+                mMethodDefinitionData.Append("const ::CrossNetRuntime::ReferenceOffset " + typeInfo.NonScopedFullName + "::s__ReferenceOffsets__[] =\n");
+                mMethodDefinitionData.Append("{\n");
+                mMethodDefinitionData.Indentation++;
+                foreach (string oneOffset in referenceOffsets)
+                {
+                    mMethodDefinitionData.Append(oneOffset + ",\n");
+                }
+                mMethodDefinitionData.Append("::CrossNetRuntime::END_OF_REFERENCE_OFFSETS\n");
+                mMethodDefinitionData.Indentation--;
+                mMethodDefinitionData.Append("};\n");
+
+                if (typeInfo.IsValueType)
+                {
+                    // The arrays of this struct will use the offsets as well
+                    // Or won't be traced at all if there is no reference in the struct
+                    string trait = (referenceOffsets.Count == 0) ? "CN_NO_REFERENCE_TRAIT(" : "CN_REFERENCE_OFFSETS_TRAIT(";
+                    mReferenceOffsetsTraits.Add(new StringTypeInfo(trait + typeInfo.FullName + ")", typeInfo));
+                }
+            }
+
             // Finally list all the methods
             // It is important to list the methods after the fields as field initialization is pushed down
             //  To the constructor and the static constructor...
@@ -1368,9 +1442,9 @@ namespace CrossNet.CppRuntime
                     mMethodDefinitionData.Append(beforeText + typeInfo.NonScopedFullName + "::" + afterText + "\n");
                     mMethodDefinitionData.Append("{\n");
                     mMethodDefinitionData.Indentation++;
-                    mMethodDefinitionData.Append("return (::System::String::__Create__(L\"");
+                    mMethodDefinitionData.Append("return (::System::String::__Create__(CROSSNET_TEXT(\"");
                     mMethodDefinitionData.AppendSameLine(instanceText);
-                    mMethodDefinitionData.AppendSameLine("\"));\n");
+                    mMethodDefinitionData.AppendSameLine("\")));\n");
                     mMethodDefinitionData.Indentation--;
                     mMethodDefinitionData.Append("}\n");
                 }
@@ -1479,7 +1553,14 @@ namespace CrossNet.CppRuntime
                     mMethodDefinitionData.Indentation++;
 
                     // TODO: Add support for all the base interfaces...
-                    mMethodDefinitionData.Append("void * * interfaceMap = ::CrossNetRuntime::InterfaceMapper::RegisterInterface();\n");
+                    if (mUseStaticIds)
+                    {
+                        mMethodDefinitionData.Append("void * * interfaceMap = ::CrossNetRuntime::InterfaceMapper::RegisterInterfaceStaticId(__GetId__());\n");
+                    }
+                    else
+                    {
+                        mMethodDefinitionData.Append("void * * interfaceMap = ::CrossNetRuntime::InterfaceMapper::RegisterInterface();\n");
+                    }
                     mMethodDefinitionData.Append(typeInfo.FullName + "::s__InterfaceMap__ = interfaceMap;\n");
 
                     mMethodDefinitionData.Indentation--;
@@ -1653,9 +1734,29 @@ namespace CrossNet.CppRuntime
                             sizeOfTypeName = "::CrossNetRuntime::BoxedObject<" + sizeOfTypeName + " >";
                         }
 
-                        mMethodDefinitionData.Append("void * * interfaceMap = ::CrossNetRuntime::InterfaceMapper::RegisterObject(sizeof(" + sizeOfTypeName + "), " + initArray + ", ");
+                        if (mUseStaticIds)
+                        {
+                            mMethodDefinitionData.Append("void * * interfaceMap = ::CrossNetRuntime::InterfaceMapper::RegisterObjectStaticId(__GetId__(), sizeof(" + sizeOfTypeName + "), " + initArray + ", ");
+                        }
+                        else
+                        {
+                            mMethodDefinitionData.Append("void * * interfaceMap = ::CrossNetRuntime::InterfaceMapper::RegisterObject(sizeof(" + sizeOfTypeName + "), " + initArray + ", ");
+                        }
                         mMethodDefinitionData.AppendSameLine(allWrappers.Count.ToString() + baseTypeInterfaceMap + ");\n");
                         mMethodDefinitionData.Append(typeInfo.FullName + "::s__InterfaceMap__ = interfaceMap;\n");
+                        if (referenceOffsets != null)
+                        {
+                            if (typeInfo.IsValueType == false)
+                            {
+                                mMethodDefinitionData.Append("::CrossNetRuntime::InterfaceMapper::SetReferenceOffsets(interfaceMap, " + typeInfo.FullName + "::s__ReferenceOffsets__);\n");
+                            }
+                            else if (referenceOffsets.Count == 0)
+                            {
+                                // For the struct, the interface map is the one of the boxed object, the offsets would be shifted
+                                // Still, when there is no reference at all, the GC can skip the boxed struct
+                                mMethodDefinitionData.Append("::CrossNetRuntime::InterfaceMapper::SetReferenceOffsets(interfaceMap, ::CrossNetRuntime::NO_REFERENCE_OFFSETS);\n");
+                            }
+                        }
 
                         mMethodDefinitionData.Indentation--;
                         mMethodDefinitionData.Append("}\n");
@@ -3340,8 +3441,8 @@ namespace CrossNet.CppRuntime
             mClassDefinitionData.Append("{\n");
             mClassDefinitionData.Indentation++;
 
-            // Add the dynamic ID definition for this type so we can box / unbox it...
-            mClassDefinitionData.Append("CN_DYNAMIC_ID()\n");
+            // Add the ID definition for this type so we can box / unbox it...
+            mClassDefinitionData.Append(GetIdMacro(typeInfo));
 
             mClassDefinitionData.Append("public:\n");
             mClassDefinitionData.Append("static void __CreateInterfaceMap__();\n");
@@ -3361,12 +3462,27 @@ namespace CrossNet.CppRuntime
                 sizeOfTypeName = "::CrossNetRuntime::BoxedObject<" + sizeOfTypeName + " >";
             }
 
-            mMethodDefinitionData.Append("void * * interfaceMap = ::CrossNetRuntime::InterfaceMapper::RegisterObject(sizeof(" + sizeOfTypeName + "));\n");
+            if (mUseStaticIds)
+            {
+                mMethodDefinitionData.Append("void * * interfaceMap = ::CrossNetRuntime::InterfaceMapper::RegisterObjectStaticId(__GetId__(), sizeof(" + sizeOfTypeName + "));\n");
+            }
+            else
+            {
+                mMethodDefinitionData.Append("void * * interfaceMap = ::CrossNetRuntime::InterfaceMapper::RegisterObject(sizeof(" + sizeOfTypeName + "));\n");
+            }
             mMethodDefinitionData.Append(typeInfo.FullName + "::s__InterfaceMap__ = interfaceMap;\n");
+            // A boxed enum doesn't contain any reference
+            mMethodDefinitionData.Append("::CrossNetRuntime::InterfaceMapper::SetReferenceOffsets(interfaceMap, ::CrossNetRuntime::NO_REFERENCE_OFFSETS);\n");
 
             mMethodDefinitionData.Indentation--;
             mMethodDefinitionData.Append("}\n");
 
+            if (typeInfo.IsGeneric == false)
+            {
+                // Same for the arrays of enums
+                mReferenceOffsetsTraits.Add(new StringTypeInfo("CN_NO_REFERENCE_TRAIT(" + typeInfo.FullName + ")", typeInfo));
+            }
+
             // Add the definition of the interface map
             mMethodDefinitionData.Append("void * * " + typeInfo.NonScopedFullName + "::s__InterfaceMap__ = NULL;\n");
 
@@ -3442,6 +3558,33 @@ namespace CrossNet.CppRuntime
             anonymousClass.AddFieldDeclaration(fieldName, fieldDeclaration);
         }
 
+        private string GetIdMacro(ITypeInfo typeInfo)
+        {
+            if (mUseStaticIds == false)
+            {
+                return ("CN_DYNAMIC_ID()\n");
+            }
+
+            // The id is known at parsing time, so __GetId__() returns a constant and the interface calls don't read it from the interface map.
+            // Note that only the ids are static, the interface maps are still built at startup:
+            // a type implementing a generic interface instanciation needs the id of the instanciation, which is only known at runtime.
+            // The runtime stops if an id collides with a dynamic id or with another parsing (see CROSSNET_CHECK).
+            int id;
+            if (mStaticIds.TryGetValue(typeInfo, out id) == false)
+            {
+                if (typeInfo.Type == ObjectType.INTERFACE)
+                {
+                    id = mNextStaticInterfaceId++;
+                }
+                else
+                {
+                    id = mNextStaticObjectId--;
+                }
+                mStaticIds[typeInfo] = id;
+            }
+            return ("CN_STATIC_ID(" + id.ToString() + ")\n");
+        }
+
         public void GenerateAnonymousClasses()
         {
             foreach (KeyValuePair<string, AnonymousClass> kvp in mAnonymousClasses)
@@ -3536,7 +3679,12 @@ namespace CrossNet.CppRuntime
         private IList<StringTypeInfo> mStaticConstructorList = new List<StringTypeInfo>();
         private IList<StringTypeInfo> mInterfaceWrapperList = new List<StringTypeInfo>();
         private IList<StringTypeInfo> mAssemblyTrace = new List<StringTypeInfo>();
+        private IList<StringTypeInfo> mReferenceOffsetsTraits = new List<StringTypeInfo>();
         private IDictionary<string, Type> mDontGenerateTypes = new Dictionary<string, Type>();
+        private bool mUseStaticIds;
+        private int mNextStaticInterfaceId;
+        private int mNextStaticObjectId;
+        private IDictionary<ITypeInfo, int> mStaticIds = new Dictionary<ITypeInfo, int>();
 
         class AnonymousClass
         {
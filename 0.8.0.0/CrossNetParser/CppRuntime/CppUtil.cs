@@ -51,46 +51,6 @@ namespace CrossNet.CppRuntime
             return (text);
         }
 
-        // If you want to change this code, make sure that the runtime is updated accordingly...
-        // And the other way around too
-        //  Search for int CrossNetRuntime::GetHashCode(void * buffer, int size)
-        public static Int32 GetStringHashCode(String str)
-        {
-#if DISABLED    // String pool changed this behavior
-            Debug.Assert(str.StartsWith("\""));
-            Debug.Assert(str.EndsWith("\""));
-
-            // Remove the first and last "
-            str = str.Substring(1, str.Length - 2);
-
-#warning GetStringHashCode doesn't handle correctly escape characters...
-#endif
-
-            // The assumption is that the hashcode is calculated at runtime with FNV1
-            const UInt32 OFFSET_BASIS = 2166136261;
-            const UInt32 FNV_PRIME = 16777619;
-
-            UInt32 hashCode = OFFSET_BASIS;
-            foreach (char c in str)
-            {
-                hashCode ^= (UInt32)c;
-                UInt64 result = (UInt64)hashCode * (UInt64)FNV_PRIME;
-                hashCode = (UInt32)(result & 0xffffffff);
-            }
-
-            if (hashCode == 0)
-            {
-                // Don't allow hash value of 0
-                hashCode = 1;
-            }
-            unchecked
-            {
-                // Do the conversion from the unsigned type to the signed type in unchecked mode
-                // Otherwise it is surprisingly a pain...
-                return (Int32)(hashCode);
-            }
-        }
-
         public static string GetNextTempVariable()
         {
             string tempVar = "__temp" + tempVarCounter + "__";
@@ -133,7 +133,8 @@ namespace CrossNet.CppRuntime
         // Duplicated from CppExpressionGenerator, we might want to improve this...
         private static string NormalizeStringExpression(string text)
         {
-            StringBuilder sb = new StringBuilder("L\"", text.Length);
+            // CROSSNET_TEXT() adds the prefix that matches System::Char (L or u), see CrossNetRuntime/Defines.h
+            StringBuilder sb = new StringBuilder("CROSSNET_TEXT(\"", text.Length);
             foreach (char c in text)
             {
                 ushort value = (ushort)c;
@@ -146,7 +147,7 @@ namespace CrossNet.CppRuntime
                     // Usually reporting that the number is too wide
                     // We solve this issue by breaking the string sequence
                     sb.Append(value.ToString("x4"));
-                    sb.Append("\" L\"");
+                    sb.Append("\") CROSSNET_TEXT(\"");
                 }
                 else
                 {
@@ -167,7 +168,7 @@ namespace CrossNet.CppRuntime
                             // So if you have, 0-9 a-f characters after the hex sequence, the compiler will still read them and interpret them wrongly
                             // Usually reporting that the number is too wide
                             // We solve this issue by breaking the string sequence
-                            sb.Append("\\x0000\" L\"");
+                            sb.Append("\\x0000\") CROSSNET_TEXT(\"");
                             break;
                         case '\n':
                             sb.Append("\\n");
@@ -182,7 +183,7 @@ namespace CrossNet.CppRuntime
                     }
                 }
             }
-            sb.Append("\"");
+            sb.Append("\")");
             return (sb.ToString());
         }
 
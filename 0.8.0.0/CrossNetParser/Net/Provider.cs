@@ -81,6 +81,7 @@ namespace CrossNet.Net
             string outputHeaderFolder = Path.GetTempPath();
             bool generateImplementation = true;
             string mainInclude = Path.GetTempFileName();
+            int firstStaticId = 0;
 
             XmlReader reader = XmlReader.Create(fileName);
             XmlDocument doc = new XmlDocument();
@@ -107,6 +108,7 @@ namespace CrossNet.Net
                             data.GenerateImplementation = generateImplementation;
                             data.Mode = outputMode;
                             data.MainInclude = mainInclude;
+                            data.FirstStaticId = firstStaticId;
                             assemblies.Add(data);
                         }
                         break;
@@ -178,6 +180,21 @@ namespace CrossNet.Net
                         mainInclude = childNode.InnerText;
                         break;
 
+                    case FIRST_STATIC_ID:
+                        {
+                            int result;
+                            if (int.TryParse(childNode.InnerText, out result) && (result >= 0))
+                            {
+                                firstStaticId = result;
+                            }
+                            else
+                            {
+                                Console.WriteLine("The XML tag " + childNode.Name + " cannot be converted to a positive integer!");
+                                return (false);
+                            }
+                        }
+                        break;
+
                     case NO_BEEP:
                         playBeep = false;
                         break;
@@ -486,6 +503,7 @@ namespace CrossNet.Net
         public const string OUTPUT_HEADER_FOLDER = "outputheaderfolder";
         public const string GENERATE_IMPLEMENTATION = "generateimplementation";
         public const string MAIN_INCLUDE = "maininclude";
+        public const string FIRST_STATIC_ID = "firststaticid";
         public const string COMMENT = "#comment";
 
         static IServiceProvider sServiceProvider = null;
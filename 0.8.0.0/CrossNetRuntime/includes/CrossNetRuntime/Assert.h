@@ -37,4 +37,8 @@
 
 #endif
 
+// Same crash, but in all the builds
+//  Only for the setup errors that would silently corrupt the runtime otherwise (like a type id given twice)
+#define CROSSNET_CHECK(a, b)        if ((a) == false)   {   __asm { int 3   } }
+
 #endif	// __CROSSNET_ASSERT_H__
\ No newline at end of file
@@ -0,0 +1,99 @@
+/*
+    CrossNet - Copyright (c) 2007 Olivier Nallet
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+    OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __CROSSNET_COMPOSITEFORMAT_H__
+#define __CROSSNET_COMPOSITEFORMAT_H__
+
+#include "CrossNetRuntime/Internal/Primitives.h"
+#include <vector>
+
+namespace System
+{
+    class IFormatProvider;
+    class Object;
+    class String;
+
+    namespace Text
+    {
+        class StringBuilder;
+    }
+}
+
+namespace CrossNetRuntime
+{
+    // Composite formatting used by String::Format() and StringBuilder::AppendFormat()
+    //
+    //  A format like "Item {0,-8} costs {1:X}" is parsed only once into a list of tokens (literal, argument index, alignment, format specifier).
+    //  The tokens are cached per format string: the key is the string pointer (format strings are pooled), and the cached strings
+    //  are traced so the pointer can't be reused by another string while it is in the cache.
+    //  Each format can only be in a few slots of the cache. When they are all used, the least used format of these slots is evicted
+    //  (and not traced anymore). The use counts are halved at each eviction, so the formats created at runtime don't stay forever.
+    //
+    //  Each argument is written directly in the StringBuilder, common boxed types are written without creating a temporary string.
+    class CompositeFormat
+    {
+    public:
+        static void     Append(::System::Text::StringBuilder * builder, ::System::IFormatProvider * provider, ::System::String * format,
+                                ::System::Object * const * args, ::System::Int32 numArgs);
+        static void     Teardown();
+
+    private:
+        CompositeFormat(::System::String * format);
+        CompositeFormat(const CompositeFormat & other);
+        CompositeFormat & operator=(const CompositeFormat & other);
+
+        void            Parse();
+        // Parses "index[,alignment][:formatSpecifier]}" and returns the position after the closing brace, -1 if incorrect
+        ::System::Int32 ParseArgument(const ::System::Char * text, ::System::Int32 position, ::System::Int32 length,
+                                ::System::Int32 literalStart, ::System::Int32 literalEnd);
+        void            AddToken(::System::Int32 literalStart, ::System::Int32 literalEnd, ::System::Int32 argIndex,
+                                ::System::Int32 alignment, ::System::String * formatSpecifier);
+        void            AppendTo(::System::Text::StringBuilder * builder, ::System::IFormatProvider * provider,
+                                ::System::Object * const * args, ::System::Int32 numArgs) const;
+
+        static int      GetCacheIndex(::System::String * format);
+        static void     Insert(int index, ::System::String * format);
+        static void     Trace(unsigned char currentMark);
+
+        struct Token
+        {
+            // Literal text written before the argument, as a range in the format string
+            ::System::Int32     mLiteralStart;
+            ::System::Int32     mLiteralLength;
+            // -1 if the token is only a literal
+            ::System::Int32     mArgIndex;
+            // Minimum width of the argument, negative to pad on the right
+            ::System::Int32     mAlignment;
+            // NULL if there is no format specifier, pooled string otherwise
+            ::System::String *  mFormatSpecifier;
+        };
+
+        ::System::String *  mFormat;
+        std::vector<Token>  mTokens;
+        ::System::Int32     mUseCount;
+
+        // Room for the few hundreds of hot formats of an application, with enough free slots to keep the probes short
+        static const int    CACHE_SIZE = 1024;
+        static const int    CACHE_PROBES = 4;
+        static const int    MAX_USE_COUNT = 0xffff;
+        static const int    MAX_INDEX = 1000000;
+        static CompositeFormat *    sCache[CACHE_SIZE];
+        // Number of cached formats currently being appended, they can't be evicted by a nested String::Format()
+        static int          sNumAppending;
+    };
+}
+
+#endif
@@ -22,9 +22,11 @@
 #include "CrossNetRuntime/Internal/Box.h"
 #include "CrossNetRuntime/Internal/Cast.h"
 #include "CrossNetRuntime/Internal/EnumWrapper.h"
+#include "CrossNetRuntime/Internal/ForEachScope.h"
 #include "CrossNetRuntime/Internal/IInterface.h"
 #include "CrossNetRuntime/Internal/PointerWrapper.h"
 #include "CrossNetRuntime/Internal/Primitives.h"
+#include "CrossNetRuntime/Internal/StackObject.h"
 #include "CrossNetRuntime/Internal/Typeof.h"
 #include "CrossnetRuntime/Internal/Tracer.h"
 
@@ -58,7 +60,7 @@ namespace CrossNetRuntime
     void Trace(unsigned char currentMark);
 
     System::Int32 GetHashCode(void * bufferToCrc, System::Int32 length);
-    System::Int32 GetHashCodeForString(::System::Char * textToCrc, System::Int32 length);
+    System::Int32 GetHashCodeForString(const ::System::Char * textToCrc, System::Int32 length);
 
     CROSSNET_FINLINE
     void SetFixed(void * /*ptr*/, System::Boolean /*fix*/)
@@ -69,6 +71,7 @@ namespace CrossNetRuntime
 }
 
 #include "CrossNetRuntime/StringPooler.h"
+#include "CrossNetRuntime/Internal/StringConcat.h"
 
 #endif
 
@@ -22,6 +22,7 @@
 
 #define CROSSNET_FINLINE    __forceinline
 #define CROSSNET_INLINE     inline
+#define CROSSNET_NOINLINE   __declspec(noinline)
 
 #define CROSSNET_STRINGIFY2(a, b)    a ## b
 #define CROSSNET_STRINGIFY3(a, b, c) a ## b ## c
@@ -51,6 +52,46 @@
 #define __memcmp__(ptr1, ptr2, size)    (memcmp(ptr1, ptr2, size))
 #endif
 
+// Range of values that are boxed only once and then shared (see CrossNetRuntime::BoxCache)
+//  Each value costs one boxed object in the permanent area
+#ifndef CROSSNET_BOX_CACHE_MIN_INT32
+#define CROSSNET_BOX_CACHE_MIN_INT32    (-128)
+#endif
+
+#ifndef CROSSNET_BOX_CACHE_MAX_INT32
+#define CROSSNET_BOX_CACHE_MAX_INT32    1023
+#endif
+
+#ifndef CROSSNET_BOX_CACHE_MAX_CHAR
+#define CROSSNET_BOX_CACHE_MAX_CHAR     255
+#endif
+
+// Number of disposed enumerators kept per enumerator type for reuse (see CrossNetRuntime::EnumeratorPool)
+//  Define it to 0 to allocate a new enumerator for each iteration
+#ifndef CROSSNET_ENUMERATOR_POOL_SIZE
+#define CROSSNET_ENUMERATOR_POOL_SIZE   8
+#endif
+
+// Storage of System::Char
+//  By default System::Char is the compiler's wchar_t, which is 16 bits with VC++.
+//  Define CROSSNET_CHAR16 to use char16_t instead, on the platforms where wchar_t is 32 bits.
+//  The literals must be written with CROSSNET_TEXT() (the parser generates them that way) so they match System::Char.
+#ifdef CROSSNET_CHAR16
+#define CROSSNET_TEXT(text)             u ## text
+#else
+#define CROSSNET_TEXT(text)             L ## text
+#endif
+
+// Use the SSE2 versions of the string search primitives when the CPU supports them (see CrossNetRuntime::StringSearch)
+//  Define it to 0 to always use the scalar versions
+#ifndef CROSSNET_STRING_SSE2
+#if defined(_M_IX86) || defined(_M_X64)
+#define CROSSNET_STRING_SSE2            1
+#else
+#define CROSSNET_STRING_SSE2            0
+#endif
+#endif
+
 // Few macros to wrap parameters for sub-macros ;)
 // We could use variadic macros but not all C++ compilers are implementing that...
 
@@ -39,6 +39,10 @@ namespace CrossNetRuntime
         static void *   UnmanagedAllocate(int size);
         static void     UnmanagedFree(int size);
 
+        // Gives the end of an allocated block back to the allocator, the block keeps the first newSize bytes
+        //  The end becomes a free block, so the GC can still walk the heap from block to block
+        static void     Shrink(void * ptr, int size, int newSize);
+
     private:
         CROSSNET_FINLINE
         static int NextPowerOf2(int size)
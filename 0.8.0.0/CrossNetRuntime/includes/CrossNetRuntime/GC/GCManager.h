@@ -30,6 +30,17 @@ namespace CrossNetRuntime
             MAX_GENERATION = 2,
         };
 
+        // Additional roots traced with the permanent objects (like the enumerator pools)
+        //  The hook is usually a static variable, it is linked in place so the registration doesn't allocate
+        //  A hook is registered only once and can't be unregistered
+        struct TraceHook
+        {
+            void        (*mTrace)(unsigned char currentMark);
+            TraceHook * mNext;
+        };
+
+        static void RegisterTraceHook(TraceHook * hook);
+
         static void Setup(const ::CrossNetRuntime::InitOptions & options);
         static void Teardown();
 
@@ -62,14 +73,29 @@ namespace CrossNetRuntime
             object->m__AllFlags__ |= currentMark;
 
             // Now trace all the other pointers
-            // One possible cache miss here to get the VTable
+            // If the parser generated the reference offsets of the type, they are stored in the interface map
+            // and we don't need the virtual call (one cache miss for the interface map, one for the offsets)
+            const ReferenceOffset * referenceOffsets = InterfaceMapper::GetReferenceOffsets(object->m__InterfaceMap__);
+            if (referenceOffsets != NULL)
+            {
+                if (*referenceOffsets != END_OF_REFERENCE_OFFSETS)
+                {
+                    TraceReferences(object, referenceOffsets, currentMark);
+                }
+                // Otherwise there is no reference in this object (like an array of integers)
+                return;
+            }
+
+            // Otherwise, one possible cache miss here to get the VTable
             // And another one to access the corresponding method
             // Note that if we are calling the same types over and over, the number of cache misses will be reduced
-
-            // There are ways to improve that...
             object->__Trace__(currentMark);
         }
 
+        // Traces the references of an instance (object or struct) described by its reference offsets
+        //  The references are prefetched before being traced, so the cache misses on the children overlap
+        static void TraceReferences(void * instance, const ReferenceOffset * referenceOffsets, unsigned char currentMark);
+
         // Specialization for strings (to speed things up a bit)
         static CROSSNET_FINLINE
         void Trace(System::String * str, unsigned char currentMark)
@@ -116,6 +142,7 @@ namespace CrossNetRuntime
         static double                       sNumSecondsInTracingStatics;
         static double                       sNumSecondsInCollect;
         static void *                       sTopOfStack;
+        static TraceHook *                  sTraceHooks;
     };
 }
 
@@ -17,6 +17,8 @@
 #define __INTERFACE_MAP_H__
 
 #include <vector>
+// For offsetof (used by CN_REFERENCE_OFFSET)
+#include <stddef.h>
 #include "CrossNetRuntime/Defines.h"
 #include "CrossNetRuntime/InitOptions.h"
 
@@ -36,6 +38,16 @@ namespace CrossNetRuntime
         IInterface *    mInterfaceWrapper;
     };
 
+    // Offset in bytes of a reference (class, interface, array, string or delegate) from the start of an instance
+    //  The parser generates the list of the references of each type, ended by END_OF_REFERENCE_OFFSETS
+    //  so the GC can trace the instances without calling the virtual __Trace__()
+    typedef int ReferenceOffset;
+    const ReferenceOffset END_OF_REFERENCE_OFFSETS = -1;
+    // Shared by all the types without reference
+    extern const ReferenceOffset NO_REFERENCE_OFFSETS[];
+
+#define CN_REFERENCE_OFFSET(Type, member)   ((::CrossNetRuntime::ReferenceOffset)offsetof(Type, member))
+
     class InterfaceMapper
     {
     public:
@@ -50,6 +62,11 @@ namespace CrossNetRuntime
         static void * * RegisterInterface(InterfaceInfo * info = NULL, int numInterfaceInfos = 0);
         static void * * RegisterObject(size_t size, InterfaceInfo * info = NULL, int numInterfaceInfos = 0, void * * parentInterfaceMap = NULL);
 
+        // Serialize the lazy registration of the generic types (see CN_MULTIPLE_DYNAMIC_*)
+        //  The lock is recursive as registering a type can register its base type and its interfaces
+        static void Lock();
+        static void Unlock();
+
         CROSSNET_FINLINE
         static size_t   GetSize(void * * interfaceMap)
         {
@@ -109,12 +126,74 @@ namespace CrossNetRuntime
             return (int)(*interfaceMap);
         }
 
+        // The object list is written from the parent class up to the root class
+        //  As a derived class copies the list of its parent, a class is always at the same position
+        //  counted from the root, in the list of any derived class. That position is the depth of the class.
+        //  So the object list is the display of Cohen's algorithm (stored backward).
+        CROSSNET_FINLINE
+        static int      GetDepth(void * * interfaceMap)
+        {
+            return (GetNumClasses(interfaceMap));
+        }
+
+        // Returns true if the type of interfaceMap is the class of classInterfaceMap or derives from it
+        //  This is done in constant time, regardless of the depth of the hierarchy
+        CROSSNET_FINLINE
+        static bool     IsSameOrSubclass(void * * interfaceMap, void * * classInterfaceMap)
+        {
+            int classId = GetId(classInterfaceMap);
+            if (GetId(interfaceMap) == classId)
+            {
+                // Most probable cast, and the current class is not in the object list anyway
+                return (true);
+            }
+            int numClasses;
+            int numInterfaces = GetNumInterfacesAndClasses(interfaceMap, &numClasses);
+            int depth = GetDepth(classInterfaceMap);
+            if (depth >= numClasses)
+            {
+                // The class is deeper than any parent of the type, it can't be one of them
+                return (false);
+            }
+            int * display = GetObjectList(interfaceMap, numInterfaces);
+            // The root is the last class of the list (i.e. the lowest address)
+            return (display[depth - (numClasses - 1)] == classId);
+        }
+
+        // Returns true if the class of interfaceMap implements the interface iid
+        //  The wrapper of the interface is at interfaceMap[iid], but as the interface maps are packed together,
+        //  this slot can also be used by another type. The owner of each wrapper slot is stored separately to check that.
+        //  Only the classes (and boxed value types) are guaranteed to have a wrapper for each interface,
+        //  interface maps of interfaces don't have wrappers for their base interfaces.
+        CROSSNET_FINLINE
+        static bool     Implements(void * * interfaceMap, int iid)
+        {
+            const Segment * segment = static_cast<const Segment *>(interfaceMap[SEGMENT]);
+            int slot = (int)(interfaceMap - segment->mBuffer) + iid;
+            if (slot >= segment->mSize)
+            {
+                // After the end of the segment, no interface map could have used this slot
+                return (false);
+            }
+            return (segment->mSlotOwners[slot] == interfaceMap);
+        }
+
         CROSSNET_FINLINE
         static System::Type * GetType(void * * interfaceMap)
         {
             return (System::Type *)(interfaceMap[TYPEOF]);
         }
 
+        // NULL if the type didn't provide its reference offsets, the GC calls __Trace__() then
+        // NO_REFERENCE_OFFSETS if the instances don't contain any reference (the GC skips them entirely)
+        CROSSNET_FINLINE
+        static const ReferenceOffset * GetReferenceOffsets(void * * interfaceMap)
+        {
+            return (const ReferenceOffset *)(interfaceMap[REFERENCE_OFFSETS]);
+        }
+
+        static void SetReferenceOffsets(void * * interfaceMap, const ReferenceOffset * referenceOffsets);
+
         static bool InInterfaceMapSpace(void * pointer);
 
     private:
@@ -123,52 +202,104 @@ namespace CrossNetRuntime
         ~InterfaceMapper();
         InterfaceMapper & operator =(const InterfaceMapper & other);
 
-        static const int    MINIMUM_BASE_SLOT_SIZE = 4;
+        static const int    MINIMUM_BASE_SLOT_SIZE = 6;
         static const int    OFFSET_FROM_END_OF_BASE_SLOT = 1;
 
         static const int    CURRENT_ID = 0;
         static const int    SIZE = -1;
         static const int    NUMBER_OF_INTERFACES_AND_CLASSES = -2;
         static const int    TYPEOF = -3;
-        static const int    LIST_OF_INTERFACES_AND_CLASSES = -4;
+        static const int    SEGMENT = -4;
+        static const int    REFERENCE_OFFSETS = -5;
+        static const int    LIST_OF_INTERFACES_AND_CLASSES = -6;
 
         static const int    USED_SLOT = 0x8000;
         static const int    USED_SLOT_MASK = 0x7fff;
 
+        static const int    BITS_PER_WORD = 32;
+
+        // The interface maps are packed in one or several buffers (segments)
+        //  The first segment is the buffer provided in the InitOptions, a new one is allocated when it is full.
+        //  As the interface maps can't move, each interface map (and its wrappers) stays in the same segment.
+        struct Segment
+        {
+            void * *        mBuffer;
+            // Interface map owning each wrapper slot (NULL for any other slot)
+            void * * *      mSlotOwners;
+            // One bit per slot, set when the slot is used (header, lists or wrapper)
+            unsigned int *  mUsedSlots;
+            // Size in number of slots
+            int             mSize;
+            // There is no free slot before this index
+            int             mFirstFree;
+            void * *        mLastInterfaceMap;
+            // True if the buffer has been allocated by the InterfaceMapper
+            bool            mOwnBuffer;
+        };
+
         static void * * CreateInterfaceMap(System::Type * type, int id, size_t size, InterfaceInfo * info, int numInterfaceInfos, void * * parentInterfaceMap);
 
-        static void     UpdateFreeSlot();
-        static void * * FindNextFreeSlots(int numberOfSlots);
-        static void * * FindNextFreeSlots(void * * currentSlot, int numberOfSlots);
-        static int      RetrieveNextInterfaceId();
-        static int      RetrieveNextObjectId();
+        static Segment *    CreateSegment(void * buffer, int numSlots, bool ownBuffer);
+        static Segment *    Grow(int numberOfSlots, InterfaceInfo * info, int numInterfaceInfos);
+        static int          FindFreeSlots(const Segment * segment, int numberOfSlots, InterfaceInfo * info, int numInterfaceInfos);
+        static int          FindFreeRun(const Segment * segment, int start, int numberOfSlots);
+        static void         UseSlot(Segment * segment, int slot);
+        static void         UpdateFirstFree(Segment * segment);
+        static int          RetrieveNextInterfaceId();
+        static int          RetrieveNextObjectId();
+
+        CROSSNET_FINLINE
+        static bool         IsSlotUsed(const Segment * segment, int slot)
+        {
+            return ((segment->mUsedSlots[slot / BITS_PER_WORD] & (1u << (slot % BITS_PER_WORD))) != 0);
+        }
 
         static System::Type *   CreateSystemType();
         static void             TraceSystemType(System::Type * type, unsigned char currentMark);
 
-        static void * *         sInterfaceMap;
-        static int              sInterfaceMapSize;
-        static void * *         sNextFreeSlot;
+        static std::vector<Segment *>   sSegments;
+        static int              sSegmentSize;
         static int              sNextInterfaceId;
         static int              sNextObjectId;
-        static void *           sLastInterfaceMap;
         static std::vector<int> sStaticInterfaceId;
         static std::vector<int> sStaticObjectId;
         static std::vector<::System::Type *> sAllTypes;
     };
+
+    class InterfaceMapperLock
+    {
+    public:
+        InterfaceMapperLock()
+        {
+            InterfaceMapper::Lock();
+        }
+
+        ~InterfaceMapperLock()
+        {
+            InterfaceMapper::Unlock();
+        }
+    };
 }
 
 
 // Use this IID declaration if you know ahead of time your IID for the interface and you want to "reserve" it.
 // This definition gives you the most speed and the less memory consumption at the cost of having less dynamic types.
-// It's the user's responsability to make sure its IDs are not colliding (the interface mapper will check it at runtime).
+// It's the user's responsability to make sure its IDs are not colliding (the interface mapper will check it at runtime, in all the builds).
 // You can have a major issue if another assembly is colliding with your IID as you will have to regenerate them.
 // If you are going to use them, it's better to use them on low level assmeblies that don't change a lot
 // instead of several high-level assemblies that you are iterating over often.
 
-// Also all the static IID interfaces / objects must be registered first to the InterfaceMapper before starting the registration
-// of the dynamic IID. Failing to do so might create a collision (for example, a dynamic IID is allocated to 100,
-// and then a static IID tries to be registered to 100 as well).
+// Also all the static IID interfaces / objects must be registered first to the InterfaceMapper before the dynamic IID
+// reach the same range. Failing to do so creates a collision (for example, a dynamic IID is allocated to 100,
+// and then a static IID tries to be registered to 100 as well), this stops the registration (see CROSSNET_CHECK).
+
+// The parser generates static IIDs for every non-generic type when the configuration file specifies <FirstStaticId>.
+// The interfaces are numbered from FirstStaticId, the objects from -(FirstStaticId + 1), so FirstStaticId must be greater than
+// the number of types registered dynamically before (CrossNetRuntime types, generic instanciations...).
+// The wrapper of an interface is at interfaceMap[iid], so the gap between the dynamic and the static ids spreads
+// the interface maps implementing both kinds of interfaces: FirstStaticId should be just above the dynamic ids.
+// Only the ids are static: a non-generic type can implement a generic interface instanciation, whose id is only known at runtime,
+// so the interface maps are still built at startup.
 
 #define CN_STATIC_ID(iid)                                   \
     public:                                                 \
@@ -244,24 +375,29 @@ namespace CrossNetRuntime
 
 // Use this IID declaration only for templated / generic interfaces and objects.
 // Although you could use this definition instead of the simpler dynamic IID, you really don't want to.
-// This version is significantly slower than the two other versions, but it has the advantage of handling gracefully
+// This version is slower than the two other versions, but it has the advantage of handling gracefully
 // several specializations of the same code for template.
 // So for example IMyInterfac<int> and IMyInterface<bool> will have different IIDs.
 // For templated code, if you are using the dynamic IID instead of this version, you'll have link error for each
 // specialization (for example IMyInterface<int>::s__InterfaceMap__ and IMyInterface<bool>::s__InterfaceMap__
 // will be missing.
 
-#define CN_MULTIPLE_DYNAMIC_INTERFACE_ID0()                 \
+// The specializations are not known by the runtime, so they are registered the first time __GetInterfaceMap__() is called.
+// The fast path is one volatile load (acquire semantic with MSVC) and a test, the registration itself is not inlined.
+// The registration takes the InterfaceMapper lock and checks again, so two threads using a specialization
+// for the first time at the same time register it only once. The interface map is published with a volatile store
+// (release semantic with MSVC) when it is completely initialized.
+#define CN__MULTIPLE_DYNAMIC_GET_INTERFACE_MAP__()          \
     public:                                                 \
     static void * * __GetInterfaceMap__()                   \
     {                                                       \
-        static void * * s__InterfaceMap__ = NULL;           \
-        if (s__InterfaceMap__ == NULL)                      \
+        static void * * volatile s__InterfaceMap__ = NULL;  \
+        void * * interfaceMap = s__InterfaceMap__;          \
+        if (interfaceMap == NULL)                           \
         {                                                   \
-            void * * interfaceMap = CrossNetRuntime::InterfaceMapper::RegisterInterface(); \
-            s__InterfaceMap__ = interfaceMap;               \
+            interfaceMap = __RegisterInterfaceMap__(&s__InterfaceMap__);  \
         }                                                   \
-        return (s__InterfaceMap__);                         \
+        return (interfaceMap);                              \
     }                                                       \
     public:                                                 \
     static int __GetId__()                                  \
@@ -270,71 +406,89 @@ namespace CrossNetRuntime
         return (int)(*interfaceMap);                        \
     }
 
+#define CN_MULTIPLE_DYNAMIC_INTERFACE_ID0()                 \
+    private:                                                \
+    static CROSSNET_NOINLINE void * * __RegisterInterfaceMap__(void * * volatile * interfaceMapStorage)  \
+    {                                                       \
+        CrossNetRuntime::InterfaceMapperLock lock;          \
+        if (*interfaceMapStorage == NULL)                   \
+        {                                                   \
+            void * * interfaceMap = CrossNetRuntime::InterfaceMapper::RegisterInterface(); \
+            *interfaceMapStorage = interfaceMap;            \
+        }                                                   \
+        return (*interfaceMapStorage);                      \
+    }                                                       \
+    CN__MULTIPLE_DYNAMIC_GET_INTERFACE_MAP__()
+
 // The reason we are using this is only for the reflection information...
 // So we can tell on a given interface what interfaces are derived from
 // I guess we could also use this to make sure that an implementation is
 // implementing all the interfaces correctly...
 #define CN_MULTIPLE_DYNAMIC_INTERFACE_ID(a)                 \
-    public:                                                 \
-    static void * * __GetInterfaceMap__()                   \
+    private:                                                \
+    static CROSSNET_NOINLINE void * * __RegisterInterfaceMap__(void * * volatile * interfaceMapStorage)  \
     {                                                       \
-        static void * * s__InterfaceMap__ = NULL;           \
-        if (s__InterfaceMap__ == NULL)                      \
+        CrossNetRuntime::InterfaceMapperLock lock;          \
+        if (*interfaceMapStorage == NULL)                   \
         {                                                   \
             CrossNetRuntime::InterfaceInfo info[] =            \
             {   a   };                                      \
             void * * interfaceMap = CrossNetRuntime::InterfaceMapper::RegisterInterface(info, sizeof(info) / sizeof(info[0])); \
-            s__InterfaceMap__ = interfaceMap;               \
+            *interfaceMapStorage = interfaceMap;            \
         }                                                   \
-        return (s__InterfaceMap__);                         \
+        return (*interfaceMapStorage);                      \
     }                                                       \
-    public:                                                 \
-    static int __GetId__()                                  \
-    {                                                       \
-        void * * interfaceMap = __GetInterfaceMap__();      \
-        return (int)(*interfaceMap);                        \
-    }
+    CN__MULTIPLE_DYNAMIC_GET_INTERFACE_MAP__()
 
 
 #define CN_MULTIPLE_DYNAMIC_OBJECT_ID0(T, b)                \
-    public:                                                 \
-    static void * * __GetInterfaceMap__()                   \
+    private:                                                \
+    static CROSSNET_NOINLINE void * * __RegisterInterfaceMap__(void * * volatile * interfaceMapStorage)  \
     {                                                       \
-        static void * * s__InterfaceMap__ = NULL;           \
-        if (s__InterfaceMap__ == NULL)                      \
+        CrossNetRuntime::InterfaceMapperLock lock;          \
+        if (*interfaceMapStorage == NULL)                   \
         {                                                   \
             void * * interfaceMap = CrossNetRuntime::InterfaceMapper::RegisterObject(T, NULL, 0, b);  \
-            s__InterfaceMap__ = interfaceMap;               \
+            *interfaceMapStorage = interfaceMap;            \
         }                                                   \
-        return (s__InterfaceMap__);                         \
+        return (*interfaceMapStorage);                      \
     }                                                       \
-    public:                                                 \
-    static int __GetId__()                                  \
-    {                                                       \
-        void * * interfaceMap = __GetInterfaceMap__();      \
-        return (int)(*interfaceMap);                        \
-    }
+    CN__MULTIPLE_DYNAMIC_GET_INTERFACE_MAP__()
 
 #define CN_MULTIPLE_DYNAMIC_OBJECT_ID(T, a, b)              \
-    public:                                                 \
-    static void * * __GetInterfaceMap__()                   \
+    private:                                                \
+    static CROSSNET_NOINLINE void * * __RegisterInterfaceMap__(void * * volatile * interfaceMapStorage)  \
     {                                                       \
-        static void * * s__InterfaceMap__ = NULL;           \
-        if (s__InterfaceMap__ == NULL)                      \
+        CrossNetRuntime::InterfaceMapperLock lock;          \
+        if (*interfaceMapStorage == NULL)                   \
         {                                                   \
             CrossNetRuntime::InterfaceInfo info[] =            \
             {   a   };                                      \
             void * * interfaceMap = CrossNetRuntime::InterfaceMapper::RegisterObject(T, info, sizeof(info) / sizeof(info[0]), b); \
-            s__InterfaceMap__ = interfaceMap;               \
+            *interfaceMapStorage = interfaceMap;            \
         }                                                   \
-        return (s__InterfaceMap__);                         \
+        return (*interfaceMapStorage);                      \
     }                                                       \
-    public:                                                 \
-    static int __GetId__()                                  \
+    CN__MULTIPLE_DYNAMIC_GET_INTERFACE_MAP__()
+
+// Same as CN_MULTIPLE_DYNAMIC_OBJECT_ID, with the reference offsets of the type (NULL to use __Trace__())
+//  Used by the runtime containers to tell the GC when the content doesn't need to be traced
+#define CN_MULTIPLE_DYNAMIC_OBJECT_ID_WITH_OFFSETS(T, a, b, offsets)    \
+    private:                                                \
+    static CROSSNET_NOINLINE void * * __RegisterInterfaceMap__(void * * volatile * interfaceMapStorage)  \
     {                                                       \
-        void * * interfaceMap = __GetInterfaceMap__();      \
-        return (int)(*interfaceMap);                        \
-    }
+        CrossNetRuntime::InterfaceMapperLock lock;          \
+        if (*interfaceMapStorage == NULL)                   \
+        {                                                   \
+            CrossNetRuntime::InterfaceInfo info[] =            \
+            {   a   };                                      \
+            void * * interfaceMap = CrossNetRuntime::InterfaceMapper::RegisterObject(T, info, sizeof(info) / sizeof(info[0]), b); \
+            CrossNetRuntime::InterfaceMapper::SetReferenceOffsets(interfaceMap, offsets);  \
+            *interfaceMapStorage = interfaceMap;            \
+        }                                                   \
+        return (*interfaceMapStorage);                      \
+    }                                                       \
+    CN__MULTIPLE_DYNAMIC_GET_INTERFACE_MAP__()
 
 #define CN_IMPLEMENT(a) {   a::__GetId__(), new a   }
 
@@ -335,6 +335,7 @@ namespace CrossNetRuntime
         static System::UInt16 Parse(System::String * format, System::Globalization::NumberStyles style);
         static System::UInt16 Parse(System::String * format, System::IFormatProvider * /*provider*/);
         static System::UInt16 Parse(System::String * format, System::Globalization::NumberStyles style, System::IFormatProvider * provider);
+        static System::Boolean TryParse(System::String * s, System::UInt16 * result);
     };
 
     // Specialization for System::Int32
@@ -378,6 +379,7 @@ namespace CrossNetRuntime
         static System::Int32 Parse(System::String * format, System::Globalization::NumberStyles style);
         static System::Int32 Parse(System::String * format, System::IFormatProvider * /*provider*/);
         static System::Int32 Parse(System::String * format, System::Globalization::NumberStyles style, System::IFormatProvider * provider);
+        static System::Boolean TryParse(System::String * s, System::Int32 * result);
     };
 
     // Specialization for System::UInt32
@@ -419,6 +421,7 @@ namespace CrossNetRuntime
         static System::UInt32 Parse(System::String * format, System::Globalization::NumberStyles style);
         static System::UInt32 Parse(System::String * format, System::IFormatProvider * /*provider*/);
         static System::UInt32 Parse(System::String * format, System::Globalization::NumberStyles style, System::IFormatProvider * provider);
+        static System::Boolean TryParse(System::String * s, System::UInt32 * result);
     };
 
     // Specialization for System::Int64
@@ -460,6 +463,7 @@ namespace CrossNetRuntime
         static System::Int64 Parse(System::String * format, System::Globalization::NumberStyles style);
         static System::Int64 Parse(System::String * format, System::IFormatProvider * /*provider*/);
         static System::Int64 Parse(System::String * format, System::Globalization::NumberStyles style, System::IFormatProvider * provider);
+        static System::Boolean TryParse(System::String * s, System::Int64 * result);
     };
 
     // Specialization for System::UInt64
@@ -501,6 +505,7 @@ namespace CrossNetRuntime
         static System::UInt64 Parse(System::String * format, System::Globalization::NumberStyles style);
         static System::UInt64 Parse(System::String * format, System::IFormatProvider * /*provider*/);
         static System::UInt64 Parse(System::String * format, System::Globalization::NumberStyles style, System::IFormatProvider * provider);
+        static System::Boolean TryParse(System::String * s, System::UInt64 * result);
     };
 
     // Specialization for System::Single
@@ -546,6 +551,7 @@ namespace CrossNetRuntime
         static System::Single Parse(System::String * format, System::Globalization::NumberStyles style);
         static System::Single Parse(System::String * format, System::IFormatProvider * /*provider*/);
         static System::Single Parse(System::String * format, System::Globalization::NumberStyles style, System::IFormatProvider * provider);
+        static System::Boolean TryParse(System::String * s, System::Single * result);
 
         static System::Boolean IsInfinity(System::Single);
         static System::Boolean IsNaN(System::Single);
@@ -915,6 +921,7 @@ namespace CrossNetRuntime
         static System::Byte Parse(System::String * format, System::Globalization::NumberStyles style);
         static System::Byte Parse(System::String * format, System::IFormatProvider * /*provider*/);
         static System::Byte Parse(System::String * format, System::Globalization::NumberStyles style, System::IFormatProvider * provider);
+        static System::Boolean TryParse(System::String * s, System::Byte * result);
     };
 
     // Specialization for System::SByte
@@ -956,6 +963,7 @@ namespace CrossNetRuntime
         static System::SByte Parse(System::String * format, System::Globalization::NumberStyles style);
         static System::SByte Parse(System::String * format, System::IFormatProvider * /*provider*/);
         static System::SByte Parse(System::String * format, System::Globalization::NumberStyles style, System::IFormatProvider * provider);
+        static System::Boolean TryParse(System::String * s, System::SByte * result);
     };
 
 // Use a macro for the wrapper, in reality what we would like is define a Wrapper type
@@ -1046,6 +1054,47 @@ namespace CrossNetRuntime
 
 #undef DEFINE_WRAPPER
 
+    // Shared boxes for the most common values (booleans, characters and small integers)
+    //  The boxed objects are immutable, so boxing the same value can return the same instance
+    //  They are created by Setup() in a permanent area, outside of the GC allocation space,
+    //  so they are never swept (and never traced from the stack either)
+#define DEFINE_BOX_CACHE(t, first, last)                                                \
+    template <>                                                                         \
+    class BoxCache<BaseTypeWrapper<t> >                                                 \
+    {                                                                                   \
+    public:                                                                             \
+        static CROSSNET_FINLINE                                                         \
+        System::Object * GetOrCreate(BaseTypeWrapper<t> value)                          \
+        {                                                                               \
+            /* Unsigned, so nothing overflows and the values below FIRST are too big */ \
+            System::UInt32 index = (System::UInt32)(System::Int32)(t)value;             \
+            index -= (System::UInt32)FIRST;                                             \
+            if (index < (System::UInt32)NUM_BOXES)                                      \
+            {                                                                           \
+                CROSSNET_ASSERT(sBoxes[index] != NULL, "The box cache is not set up!"); \
+                return (sBoxes[index]);                                                 \
+            }                                                                           \
+            return (BoxedObject<BaseTypeWrapper<t> >::__Create__(value));               \
+        }                                                                               \
+                                                                                        \
+        static void Setup();                                                            \
+                                                                                        \
+    private:                                                                            \
+        enum                                                                            \
+        {                                                                               \
+            FIRST = (first),                                                            \
+            NUM_BOXES = (last) - (first) + 1,                                           \
+        };                                                                              \
+                                                                                        \
+        static System::Object * sBoxes[NUM_BOXES];                                      \
+    };
+
+    DEFINE_BOX_CACHE(System::Boolean, 0, 1)
+    DEFINE_BOX_CACHE(System::Char, 0, CROSSNET_BOX_CACHE_MAX_CHAR)
+    DEFINE_BOX_CACHE(System::Int32, CROSSNET_BOX_CACHE_MIN_INT32, CROSSNET_BOX_CACHE_MAX_INT32)
+
+#undef DEFINE_BOX_CACHE
+
     // Same kind of thing here, but this to determine the default value
     // It's either NULL for a class, or the default constructor for a struct (0 for a base type).
 
@@ -1133,7 +1182,7 @@ template <typename T, typename enumName>
 CROSSNET_FINLINE
 System::String *    StructEnum<T, enumName>::ToString()
 {
-    return (System::String::__Create__(L"Enum"));
+    return (System::String::__Create__(CROSSNET_TEXT("Enum")));
 }
 
 }
@@ -19,13 +19,33 @@
 #include "CrossNetRuntime/System/Object.h"
 #include "CrossNetRuntime/Internal/Cast.h"
 
+// For the placement new
+#include <new>
+
 namespace CrossNetRuntime
 {
+    template <typename U>
+    class BoxedObject;
+
+    // Cache of the boxed objects
+    //  By default, every boxing creates a new instance
+    //  Some base types are specialized in BaseTypes.h to return shared boxes for the most common values
+    template <typename U>
+    class BoxCache
+    {
+    public:
+        static CROSSNET_FINLINE
+        System::Object * GetOrCreate(const U & value)
+        {
+            return (BoxedObject<U>::__Create__(value));
+        }
+    };
+
     template <typename U, typename V>
     static CROSSNET_FINLINE
     U * Box(const V & instance)
     {
-        System::Object * obj = BoxedObject<CrossNetRuntime::GenWrapper< V >::ConvertedType >::__Create__(instance);
+        System::Object * obj = BoxCache<CrossNetRuntime::GenWrapper< V >::ConvertedType >::GetOrCreate(instance);
         CROSSNET_FATAL(Cast<U>(obj) != NULL, STRINGIFY3("Could not cast the instance to the class ", U, "!"));
         return (U *)(obj);
     }
@@ -66,6 +86,13 @@ namespace CrossNetRuntime
             return (new BoxedObject(value));
         }
 
+        // Creates the instance in a buffer that is not allocated by the GC (used by BoxCache)
+        //  The instance is never swept, so it has to stay valid until the end of the application
+        static BoxedObject * __CreatePermanent__(void * buffer, const U & value)
+        {
+            return (::new (buffer) BoxedObject(value));
+        }
+
         CROSSNET_FINLINE
         operator U()
         {
@@ -120,7 +147,7 @@ namespace CrossNetRuntime
     public:
         static U   Unbox(System::Object * instance)
         {
-            CROSSNET_FATAL(instance->__Cast__(U::__GetId__()) != NULL, STRINGIFY3("Could not unbox the instance to the structure type ", U, "!"));
+            CROSSNET_FATAL(instance->__Cast__(U::__GetInterfaceMap__()) != NULL, STRINGIFY3("Could not unbox the instance to the structure type ", U, "!"));
             BoxedObject<U> * boxedObject = static_cast<BoxedObject<U> * >(instance);
             return (*boxedObject);
         }
@@ -143,7 +170,7 @@ namespace CrossNetRuntime
         {
             if (instance != NULL)
             {
-                CROSSNET_FATAL(instance->__Cast__(U::__GetId__()) != NULL,
+                CROSSNET_FATAL(instance->__Cast__(U::__GetInterfaceMap__()) != NULL,
                     STRINGIFY3("Could not unbox the instance to the class type ", U, "!"));
             }
             return (U *)(instance);
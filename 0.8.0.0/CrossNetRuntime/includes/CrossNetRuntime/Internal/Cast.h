@@ -63,7 +63,7 @@ namespace CrossNetRuntime
         {
             return (NULL);
         }
-        void * pointer = instance->__Cast__(T::__GetId__());
+        void * pointer = instance->__Cast__(T::__GetInterfaceMap__());
         CROSSNET_FATAL(pointer != NULL, STRINGIFY3("Could not cast the instance to the type ", T, "!"));
         return (T *)(pointer);
     }
@@ -76,7 +76,7 @@ namespace CrossNetRuntime
         {
             return (NULL);
         }
-        void * pointer = ((System::Object *)instance)->__Cast__(T::__GetId__());
+        void * pointer = ((System::Object *)instance)->__Cast__(T::__GetInterfaceMap__());
         CROSSNET_FATAL(pointer != NULL, STRINGIFY3("Could not cast the instance to the type ", T, "!"));
         return (T *)(pointer);
     }
@@ -87,7 +87,7 @@ namespace CrossNetRuntime
     static CROSSNET_FINLINE
     T * FastCast(System::Object * instance)
     {
-        CROSSNET_FATAL((instance == NULL) || (instance->__Cast__(T::__GetId__()) != NULL), STRINGIFY3("Could not cast the instance to the type ", T, "!"));
+        CROSSNET_FATAL((instance == NULL) || (instance->__Cast__(T::__GetInterfaceMap__()) != NULL), STRINGIFY3("Could not cast the instance to the type ", T, "!"));
         return (T *)(instance);
     }
 
@@ -95,7 +95,7 @@ namespace CrossNetRuntime
     static CROSSNET_FINLINE
     T * FastCast(CrossNetRuntime::IInterface * instance)
     {
-        CROSSNET_FATAL((instance == NULL) || (((System::Object *)instance)->__Cast__(T::__GetId__()) != NULL), STRINGIFY3("Could not cast the instance to the type ", T, "!"));
+        CROSSNET_FATAL((instance == NULL) || (((System::Object *)instance)->__Cast__(T::__GetInterfaceMap__()) != NULL), STRINGIFY3("Could not cast the instance to the type ", T, "!"));
         return (T *)(instance);
     }
 
@@ -109,7 +109,7 @@ namespace CrossNetRuntime
         {
             return (NULL);
         }
-        void * pointer = instance->__Cast__(T::__GetId__());
+        void * pointer = instance->__Cast__(T::__GetInterfaceMap__());
         CROSSNET_FATAL(pointer != NULL, STRINGIFY3("Could not cast the instance to the interface ", T, "!"));
         return (T *)(pointer);
     }
@@ -122,7 +122,7 @@ namespace CrossNetRuntime
         {
             return (NULL);
         }
-        void * pointer = ((System::Object *)instance)->__Cast__(T::__GetId__());
+        void * pointer = ((System::Object *)instance)->__Cast__(T::__GetInterfaceMap__());
         CROSSNET_FATAL(pointer != NULL, STRINGIFY3("Could not cast the instance to the interface ", T, "!"));
         return (T *)(pointer);
     }
@@ -167,7 +167,7 @@ namespace CrossNetRuntime
         {
             return (NULL);
         }
-        void * pointer = instance->__Cast__(T::__GetId__());
+        void * pointer = instance->__Cast__(T::__GetInterfaceMap__());
         return (T *)(pointer);
     }
 
@@ -179,29 +179,34 @@ namespace CrossNetRuntime
         {
             return (NULL);
         }
-        void * pointer = ((System::Object *)(instance))->__Cast__(T::__GetId__());
+        void * pointer = ((System::Object *)(instance))->__Cast__(T::__GetInterfaceMap__());
         return (T *)(pointer);
     }
 
+    // "as" with a reference type only known as a template parameter (in generic code for example)
+    //  Any class or interface points to the same address, so we can cast with System::Object
+    //  The pointer can be NULL, in that case we know that we cannot do the conversion
+    template <typename T, typename V>
+    static CROSSNET_FINLINE
+    T * AsCast(V * instance)
+    {
+        return (AsCast<T>((System::Object *)(instance)));
+    }
+
     // "as" with a value type as right member instead of a reference
     //  This is useful for generic code for example
     template <typename T, typename V>
     static CROSSNET_FINLINE
     T * AsCast(const V & o)
     {
-        // First box the object (so we can get the corresponding interface map)
-        // TODO: Get the interface map without having to box the object!
-        System::Object * instance = Box<::System::Object>(o);
-        if (instance == NULL)
+        // The interface map of the boxed type is known statically, no need to box to find it
+        void * * interfaceMap = CrossNetRuntime::GenWrapper< V >::ConvertedType::__GetInterfaceMap__();
+        if (System::Object::__CanCast__(interfaceMap, T::__GetInterfaceMap__()) == false)
         {
-            // In some case like with generics, the object passed will actually be a NULL pointer
-            // So after the boxing, it will still return NULL
-            // We don't want to crash during the cast.
-            // In this case we know that we cannot do the conversion
             return (NULL);
         }
-        void * pointer = instance->__Cast__(T::__GetId__());
-        return (T *)(pointer);
+        // The cast is valid and the caller gets a reference, only now we have to box the value
+        return (Box<T>(o));
     }
 
     template <typename T>
@@ -212,7 +217,7 @@ namespace CrossNetRuntime
         {
             return (false);
         }
-        void * pointer = instance->__Cast__(T::__GetId__());
+        void * pointer = instance->__Cast__(T::__GetInterfaceMap__());
         return (pointer != NULL);
     }
 
@@ -224,29 +229,27 @@ namespace CrossNetRuntime
         {
             return (false);
         }
-        void * pointer = (System::Object *)(instance)->__Cast__(T::__GetId__());
+        void * pointer = ((System::Object *)(instance))->__Cast__(T::__GetInterfaceMap__());
         return (pointer != NULL);
     }
 
+    // "is" with a reference type only known as a template parameter (in generic code for example)
+    template <typename T, typename V>
+    static CROSSNET_FINLINE
+    bool IsCast(V * instance)
+    {
+        return (IsCast<T>((System::Object *)(instance)));
+    }
+
     // "is" with a value type as right member instead of a reference
     //  This is useful for generic code for example
     template <typename T, typename V>
     static CROSSNET_FINLINE
-    bool IsCast(const V & o)
+    bool IsCast(const V & /* o */)
     {
-        // First box the object (so we can get the corresponding interface map)
-        // TODO: Get the interface map without having to box the object!
-        System::Object * instance = Box<::System::Object>(o);
-        if (instance == NULL)
-        {
-            // In some case like with generics, the object passed will actually be a NULL pointer
-            // So after the boxing, it will still return NULL
-            // We don't want to crash during the cast.
-            // In this case we know that we cannot do the conversion
-            return (false);
-        }
-        void * pointer = instance->__Cast__(T::__GetId__());
-        return (pointer != NULL);
+        // The value is never NULL and its type is known statically, so there is nothing to box
+        void * * interfaceMap = CrossNetRuntime::GenWrapper< V >::ConvertedType::__GetInterfaceMap__();
+        return (System::Object::__CanCast__(interfaceMap, T::__GetInterfaceMap__()));
     }
 
 }
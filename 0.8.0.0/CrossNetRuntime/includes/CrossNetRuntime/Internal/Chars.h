@@ -0,0 +1,75 @@
+/*
+    CrossNet - Copyright (c) 2007 Olivier Nallet
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+    OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __CROSSNET_CHARS_H__
+#define __CROSSNET_CHARS_H__
+
+#include "CrossNetRuntime/Defines.h"
+#include "CrossNetRuntime/Internal/Primitives.h"
+
+// For towlower
+#include <wctype.h>
+
+namespace CrossNetRuntime
+{
+    // Replacements of the wcs* / wmem* functions for System::Char buffers
+    //  They don't depend on the size of wchar_t, so they work the same way when System::Char is char16_t (see CROSSNET_CHAR16).
+    //  Except for GetCharLength(), the lengths are always passed, the buffers can contain some zeros.
+
+    CROSSNET_FINLINE
+    ::System::Int32 GetCharLength(const ::System::Char * text)
+    {
+        const ::System::Char * end = text;
+        while (*end != 0)
+        {
+            ++end;
+        }
+        return ((::System::Int32)(end - text));
+    }
+
+    CROSSNET_FINLINE
+    void CopyChars(::System::Char * destination, const ::System::Char * source, ::System::Int32 count)
+    {
+        __memcopy__(destination, source, count * sizeof(::System::Char));
+    }
+
+    CROSSNET_FINLINE
+    void FillChars(::System::Char * destination, ::System::Char c, ::System::Int32 count)
+    {
+        for (::System::Int32 i = 0 ; i < count ; ++i)
+        {
+            destination[i] = c;
+        }
+    }
+
+    // Ordinal comparison, ignoring the case of each character (one character at a time, like _wcsicmp)
+    inline
+    ::System::Int32 CompareCharsIgnoreCase(const ::System::Char * a, ::System::Int32 lengthA, const ::System::Char * b, ::System::Int32 lengthB)
+    {
+        ::System::Int32 length = (lengthA < lengthB) ? lengthA : lengthB;
+        for (::System::Int32 i = 0 ; i < length ; ++i)
+        {
+            ::System::Int32 charA = (::System::Int32)towlower((wint_t)(::System::UInt16)a[i]);
+            ::System::Int32 charB = (::System::Int32)towlower((wint_t)(::System::UInt16)b[i]);
+            if (charA != charB)
+            {
+                return (charA - charB);
+            }
+        }
+        return (lengthA - lengthB);
+    }
+}
+
+#endif
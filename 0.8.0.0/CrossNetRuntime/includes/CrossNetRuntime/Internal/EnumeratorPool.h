@@ -0,0 +1,100 @@
+/*
+    CrossNet - Copyright (c) 2007 Olivier Nallet
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+    OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __CROSSNET_ENUMERATORPOOL_H__
+#define __CROSSNET_ENUMERATORPOOL_H__
+
+#include "CrossNetRuntime/Assert.h"
+#include "CrossNetRuntime/Defines.h"
+#include "CrossNetRuntime/GC/GCManager.h"
+
+namespace CrossNetRuntime
+{
+    // Recycling of the runtime enumerators that have to be returned as interfaces (so can't be value types)
+    //  GetEnumerator() pops a recycled enumerator if there is one.
+    //  Dispose() doesn't push the enumerator back, any code could still have a reference to it (and call Dispose() twice).
+    //  Only the foreach code generated by the parser recycles an enumerator, when it knows it has the only reference
+    //  (see CrossNetRuntime::ForEachScope). So a loop over an IEnumerable<T> reuses the same enumerator
+    //  instead of allocating a new one each time.
+    //
+    //  The pooled enumerators are traced as permanent roots, so they are not collected while waiting in the pool.
+    //  Each enumerator type has its own pool (like the GC allocator, the pool is not thread-safe).
+    template <typename T>
+    class EnumeratorPool
+    {
+    public:
+        // Returns NULL if the pool is empty, the caller creates a new enumerator then
+        CROSSNET_FINLINE
+        static T * Pop()
+        {
+            if (sNumEnumerators == 0)
+            {
+                return (NULL);
+            }
+            --sNumEnumerators;
+            T * enumerator = sEnumerators[sNumEnumerators];
+            sEnumerators[sNumEnumerators] = NULL;
+            return (enumerator);
+        }
+
+        CROSSNET_FINLINE
+        static void Push(T * enumerator)
+        {
+            CROSSNET_ASSERT(enumerator != NULL, "");
+            if (sNumEnumerators >= POOL_SIZE)
+            {
+                // The pool is full, the GC will collect this one
+                return;
+            }
+            if (sHook.mTrace == NULL)
+            {
+                sHook.mTrace = &Trace;
+                GCManager::RegisterTraceHook(&sHook);
+            }
+            sEnumerators[sNumEnumerators++] = enumerator;
+        }
+
+    private:
+        enum
+        {
+            // Keep at least one entry so the array is valid, Push() never uses it when the pool is disabled
+            POOL_SIZE = CROSSNET_ENUMERATOR_POOL_SIZE,
+            ARRAY_SIZE = (CROSSNET_ENUMERATOR_POOL_SIZE > 0) ? CROSSNET_ENUMERATOR_POOL_SIZE : 1,
+        };
+
+        static void Trace(unsigned char currentMark)
+        {
+            for (int i = 0 ; i < sNumEnumerators ; ++i)
+            {
+                GCManager::Trace(sEnumerators[i], currentMark);
+            }
+        }
+
+        static T *                      sEnumerators[ARRAY_SIZE];
+        static int                      sNumEnumerators;
+        static GCManager::TraceHook     sHook;
+    };
+
+    template <typename T>
+    T * EnumeratorPool<T>::sEnumerators[EnumeratorPool<T>::ARRAY_SIZE];
+
+    template <typename T>
+    int EnumeratorPool<T>::sNumEnumerators = 0;
+
+    template <typename T>
+    GCManager::TraceHook EnumeratorPool<T>::sHook = { NULL, NULL };
+}
+
+#endif
@@ -0,0 +1,73 @@
+/*
+    CrossNet - Copyright (c) 2007 Olivier Nallet
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+    OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __CROSSNET_FOREACHSCOPE_H__
+#define __CROSSNET_FOREACHSCOPE_H__
+
+#include "CrossNetRuntime/Defines.h"
+#include "CrossNetRuntime/Internal/Cast.h"
+#include "CrossNetRuntime/Internal/IInterface.h"
+#include "CrossNetRuntime/System/Array.h"
+#include "CrossNetRuntime/System/IDisposable.h"
+
+namespace CrossNetRuntime
+{
+    // Disposes the enumerator of a foreach loop when the scope of the loop is left
+    //  The parser generates it when the enumerator is an interface implementing System::IDisposable (like IEnumerator<T>):
+    //      ::CrossNetRuntime::ForEachScope __temp__(enumerable, enumerator);
+    //      while (...)
+    //  Like the finally block generated by C#, the destructor is called for return, break and goto as well.
+    //
+    //  When the enumerable is an array, the enumerator has just been created by the array and only this loop knows it,
+    //  so it can be given back to the enumerator pool (see EnumeratorPool).
+    //  Any other enumerator might still be referenced somewhere (by the enumerable itself for example), it is only disposed.
+    class ForEachScope
+    {
+    public:
+        CROSSNET_FINLINE
+        ForEachScope(IInterface * enumerable, IInterface * enumerator)
+            :
+            mEnumerable(reinterpret_cast<System::Object *>(enumerable)),
+            mEnumerator(reinterpret_cast<System::Object *>(enumerator))
+        {
+            // Do nothing...
+        }
+
+        CROSSNET_FINLINE
+        ~ForEachScope()
+        {
+            if (mEnumerator == NULL)
+            {
+                return;
+            }
+            INTERFACE__CALL(mEnumerator, System::IDisposable)->Dispose(mEnumerator);
+            if ((mEnumerable != NULL) && (mEnumerable->__Cast__(System::Array::__GetInterfaceMap__()) != NULL))
+            {
+                static_cast<System::Array *>(mEnumerable)->__RecycleEnumerator__(mEnumerator);
+            }
+        }
+
+    private:
+        // Declared but not implemented on purpose, the enumerator must be disposed only once
+        ForEachScope(const ForEachScope & other);
+        ForEachScope & operator=(const ForEachScope & other);
+
+        System::Object *    mEnumerable;
+        System::Object *    mEnumerator;
+    };
+}
+
+#endif
@@ -22,7 +22,12 @@ namespace System
 {
     // Define the primitive types
 	typedef bool Boolean;
+#ifdef CROSSNET_CHAR16
+    // 16 bits characters even where wchar_t is 32 bits (see CROSSNET_TEXT)
+    typedef char16_t Char;
+#else
 	typedef __wchar_t Char;
+#endif
     typedef int Int32;
     typedef signed long long Int64;
     typedef void Void;
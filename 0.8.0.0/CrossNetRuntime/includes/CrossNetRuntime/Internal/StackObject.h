@@ -0,0 +1,67 @@
+/*
+    CrossNet - Copyright (c) 2007 Olivier Nallet
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+    OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __CROSSNET_STACKOBJECT_H__
+#define __CROSSNET_STACKOBJECT_H__
+
+#include "CrossNetRuntime/Assert.h"
+#include "CrossNetRuntime/Defines.h"
+
+// For the placement new
+#include <new>
+
+namespace CrossNetRuntime
+{
+    // Storage for a managed instance that the parser proved to never escape the method that creates it
+    //  The parser generates something like this instead of calling T::__Create__():
+    //      ::CrossNetRuntime::StackObject<T> __temp__;
+    //      T * instance = (__temp__.Get()->__ctor__(parameters), __temp__.Get());
+    //
+    //  The instance is never seen by the GC:
+    //      - It is not in the GC allocation space, so ValidateRoot() skips it and Collect() doesn't sweep it.
+    //      - Its members are on the stack, so they are traced by TraceStack() like any other local variable.
+    //  As a consequence the destructor is not called at the end of the scope (like a collected object, there is no finalizer).
+    template <typename T>
+    class StackObject
+    {
+    public:
+        CROSSNET_FINLINE
+        StackObject()
+        {
+            // Same state as an instance coming from System::Object::operator new
+            //  The parser made sure that T doesn't use the variable size allocation (no array, no string)
+            __memclear__(mBuffer, sizeof(T));
+            T * instance = ::new (mBuffer) T;
+            CROSSNET_ASSERT(T::__GetInterfaceMap__() != NULL, "Interface map not set correctly!");
+            instance->m__InterfaceMap__ = T::__GetInterfaceMap__();
+        }
+
+        CROSSNET_FINLINE
+        T * Get()
+        {
+            return (reinterpret_cast<T *>(mBuffer));
+        }
+
+    private:
+        // Declared but not implemented on purpose, the instance can't be moved
+        StackObject(const StackObject & other);
+        StackObject & operator=(const StackObject & other);
+
+        // Same alignment as the GC allocations, so the code generated for T behaves the same way
+        __declspec(align(16)) unsigned char mBuffer[sizeof(T)];
+    };
+}
+
+#endif
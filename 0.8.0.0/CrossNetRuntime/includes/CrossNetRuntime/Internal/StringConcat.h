@@ -0,0 +1,75 @@
+/*
+    CrossNet - Copyright (c) 2007 Olivier Nallet
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+    OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __CROSSNET_STRINGCONCAT_H__
+#define __CROSSNET_STRINGCONCAT_H__
+
+#include "CrossNetRuntime/Assert.h"
+#include "CrossNetRuntime/Defines.h"
+#include "CrossNetRuntime/System/Object.h"
+#include "CrossNetRuntime/System/String.h"
+
+namespace CrossNetRuntime
+{
+    // Concatenation of N parts, used by the parser for the C# string concatenations
+    //  The whole chain of concatenations is flattened, and the literals are merged at parsing time:
+    //      "Test " + text + ":" + number + "."
+    //  becomes:
+    //      ::CrossNetRuntime::StringConcat< 4 >().Add(__pooled0__).Add(text).AddObject(box(number)).Add(__pooled1__).ToString()
+    //
+    //  The parts are stored on the stack (so they are traced by TraceStack() like any other local variable),
+    //  and the resulting string is allocated only once by System::String::__Concat__().
+    template <int N>
+    class StringConcat
+    {
+    public:
+        CROSSNET_FINLINE
+        StringConcat()
+            :
+            mCount(0)
+        {
+            // Do nothing...
+        }
+
+        CROSSNET_FINLINE
+        StringConcat & Add(const System::String * part)
+        {
+            CROSSNET_ASSERT(mCount < N, "Too many parts for this concatenation!");
+            mParts[mCount++] = part;
+            return (*this);
+        }
+
+        CROSSNET_FINLINE
+        StringConcat & AddObject(System::Object * part)
+        {
+            // Like .Net, a NULL object is concatenated as an empty string
+            return (Add((part != NULL) ? part->ToString() : NULL));
+        }
+
+        CROSSNET_FINLINE
+        System::String * ToString() const
+        {
+            CROSSNET_ASSERT(mCount == N, "Some parts are missing for this concatenation!");
+            return (System::String::__Concat__(mParts, mCount));
+        }
+
+    private:
+        const System::String *  mParts[N];
+        System::Int32           mCount;
+    };
+}
+
+#endif
@@ -25,7 +25,8 @@ namespace CrossNetRuntime
     {
         TM_NONE,
         TM_CLASS,
-        TM_STRUCT
+        TM_STRUCT,
+        TM_REFERENCE_OFFSETS
     };
 
     template <class T>
@@ -91,6 +92,29 @@ namespace CrossNetRuntime
     CN_ISPRIMITIVE_TRAIT(::System::Double)
     CN_ISPRIMITIVE_TRAIT(::System::Decimal)
 
+// The parser generates these traits (within the CrossNetRuntime namespace) for the structs with a generated s__ReferenceOffsets__
+//  Structs (and enums) without any reference are not traced at all, the arrays of those are traced in constant time
+#define CN_NO_REFERENCE_TRAIT(Type)         \
+    template <>                             \
+    struct GetTraceMode<Type>               \
+    {                                       \
+        static const TraceMode Value = TM_NONE; \
+    };
+
+#define CN_REFERENCE_OFFSETS_TRAIT(Type)    \
+    template <>                             \
+    struct GetTraceMode<Type>               \
+    {                                       \
+        static const TraceMode Value = TM_REFERENCE_OFFSETS; \
+    };
+
+    // False if the GC has nothing to trace in an instance of T (primitive types, structs without reference)
+    template <class T>
+    struct ContainsReferences
+    {
+        static const bool Value = (GetTraceMode<T>::Value != TM_NONE);
+    };
+
     template <typename U, typename TraceMode V>
     struct TraceTrait
     {
@@ -141,6 +165,32 @@ namespace CrossNetRuntime
         }
     };
 
+    // Specialization for structs described by their reference offsets
+    //  The references of each element are traced directly, without calling __Trace__() for each element
+    template <typename U>
+    struct TraceTrait<U, TM_REFERENCE_OFFSETS>
+    {
+        static void DoTrace(unsigned char currentMark, U * ptr, int size)
+        {
+            // Structs without reference use TM_NONE, so there is at least one reference per element
+            const ReferenceOffset * referenceOffsets = U::s__ReferenceOffsets__;
+            unsigned char * base = reinterpret_cast<unsigned char *>(ptr);
+            for (int i = 0 ; i < size ; ++i)
+            {
+                for (const ReferenceOffset * offset = referenceOffsets ; *offset != END_OF_REFERENCE_OFFSETS ; ++offset)
+                {
+                    ::CrossNetRuntime::GCManager::Trace(*reinterpret_cast<::System::Object * *>(base + *offset), currentMark);
+                }
+                base += sizeof(U);
+            }
+        }
+
+        static void DoTrace(unsigned char currentMark, U & ptr)
+        {
+            ::CrossNetRuntime::GCManager::TraceReferences(&ptr, U::s__ReferenceOffsets__, currentMark);
+        }
+    };
+
     struct Tracer
     {
         template <typename U>
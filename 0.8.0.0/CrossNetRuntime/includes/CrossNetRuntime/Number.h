@@ -0,0 +1,89 @@
+/*
+    CrossNet - Copyright (c) 2007 Olivier Nallet
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+    OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef __CROSSNET_NUMBER_H__
+#define __CROSSNET_NUMBER_H__
+
+#include "CrossNetRuntime/Internal/Primitives.h"
+
+namespace System
+{
+    class String;
+}
+
+namespace CrossNetRuntime
+{
+    // Formatting and parsing of the primitive numbers without any temporary allocation (and without the C runtime in most cases)
+    //
+    //  The integers are written two digits at a time from a table of digit pairs.
+    //  The floating points are written with the shortest digits that parse back to the same value (Ryu),
+    //  with the same layout as .NET ("123.45", "1E+15", "1.5E-07", "NaN", "Infinity"...).
+    //  The strings are created with their final length, the characters are written directly in them.
+    //
+    //  The parsing returns false if the text is not a number or if the number doesn't fit in the type.
+    //  Leading and trailing white spaces and a leading sign are accepted (NumberStyles.Integer and NumberStyles.Float),
+    //  the thousands separators are not.
+    class Number
+    {
+    public:
+        enum
+        {
+            // Enough for "-18446744073709551615"
+            MAX_INTEGER_LENGTH = 21,
+            // Enough for "-2.2250738585072014E-308"
+            MAX_FLOAT_LENGTH = 32,
+        };
+
+        static ::System::Int32      CountDigits(::System::UInt32 value);
+        static ::System::Int32      CountDigits(::System::UInt64 value);
+
+        // Writes the digits of value just before end, returns the first digit
+        static ::System::Char *     WriteDigits(::System::Char * end, ::System::UInt32 value);
+        static ::System::Char *     WriteDigits(::System::Char * end, ::System::UInt64 value);
+
+        // Writes the value in buffer (at least MAX_FLOAT_LENGTH characters), returns the number of characters written
+        static ::System::Int32      FormatDouble(::System::Char * buffer, ::System::Double value);
+        static ::System::Int32      FormatSingle(::System::Char * buffer, ::System::Single value);
+
+        static ::System::String *   ToString(::System::Int32 value);
+        static ::System::String *   ToString(::System::UInt32 value);
+        static ::System::String *   ToString(::System::Int64 value);
+        static ::System::String *   ToString(::System::UInt64 value);
+        static ::System::String *   ToString(::System::Double value);
+        static ::System::String *   ToString(::System::Single value);
+
+        // Supports "D" (with the minimum number of digits) and "X" / "x" (with the minimum number of hexadecimal digits)
+        //  numBits is the size of the original type, a negative number is written in hexadecimal as a two's complement of this size
+        //  The other formats are not supported yet, the default format is used instead
+        static ::System::String *   ToString(::System::Int64 value, ::System::String * format, ::System::Int32 numBits);
+        static ::System::String *   ToString(::System::UInt64 value, ::System::String * format);
+
+        static bool                 TryParse(const ::System::Char * text, ::System::Int32 length,
+                                                ::System::Int64 minValue, ::System::Int64 maxValue, ::System::Int64 * result);
+        static bool                 TryParse(const ::System::Char * text, ::System::Int32 length,
+                                                ::System::UInt64 maxValue, ::System::UInt64 * result);
+        static bool                 TryParse(const ::System::Char * text, ::System::Int32 length, ::System::Double * result);
+        static bool                 TryParse(const ::System::Char * text, ::System::Int32 length, ::System::Single * result);
+
+    private:
+        Number();
+        Number(const Number & other);
+        ~Number();
+        Number & operator=(Number & other);
+    };
+}
+
+#endif
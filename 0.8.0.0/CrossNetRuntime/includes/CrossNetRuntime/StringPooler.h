@@ -30,9 +30,9 @@ namespace CrossNetRuntime
     class StringPooler
     {
     public:
-        static ::System::String *   GetOrCreateString(System::Char * text);
+        static ::System::String *   GetOrCreateString(const System::Char * text);
         // This function should be used with strings that can potentially contain a zero character
-        static ::System::String *   GetOrCreateString(System::Char * text, System::Int32 length);
+        static ::System::String *   GetOrCreateString(const System::Char * text, System::Int32 length);
         static void                 Trace(unsigned char currentMark);
 
     private:
@@ -45,7 +45,7 @@ namespace CrossNetRuntime
 
         struct Key
         {
-            Key(::System::Char * buffer, ::System::Int32 length)
+            Key(const ::System::Char * buffer, ::System::Int32 length)
                 :
                 mBuffer(buffer),
                 mLength(length)
@@ -53,7 +53,7 @@ namespace CrossNetRuntime
                 // Do nothing...
             }
 
-            ::System::Char *    mBuffer;
+            const ::System::Char *  mBuffer;
             ::System::Int32     mLength;
         };
 
@@ -0,0 +1,188 @@
+/*
+    CrossNet - Copyright (c) 2007 Olivier Nallet
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+    OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef __STRINGSEARCH_H__
+#define __STRINGSEARCH_H__
+
+#include "CrossNetRuntime/Defines.h"
+#include "CrossNetRuntime/Internal/Primitives.h"
+
+namespace CrossNetRuntime
+{
+    struct InitOptions;
+
+    // Set of characters looked for by StringSearch::FindAnyChar() and FindLastAnyChar()
+    //  Build it once and reuse it when searching several times for the same characters (like String::Split() does)
+    class CharSet
+    {
+    public:
+        CharSet(const ::System::Char * chars, ::System::Int32 length);
+
+        CROSSNET_FINLINE
+        bool Contains(::System::Char c) const
+        {
+            unsigned int value = (unsigned int)c;
+            if (value < 256)
+            {
+                return ((mBitmap[value >> 5] & (1u << (value & 31))) != 0);
+            }
+            if (mAllInBitmap)
+            {
+                return (false);
+            }
+            for (int i = 0 ; i < mLength ; ++i)
+            {
+                if (mChars[i] == c)
+                {
+                    return (true);
+                }
+            }
+            return (false);
+        }
+
+        const ::System::Char *  mChars;
+        ::System::Int32         mLength;
+        // One bit per character below 256, most of the separators are there
+        unsigned int            mBitmap[256 / 32];
+        // True if none of the characters is above 255, in that case the bitmap is enough
+        bool                    mAllInBitmap;
+    };
+
+    // Search primitives used by System::String
+    //  Each primitive has a scalar version and a SSE2 version, the best one is selected by Setup() for the current CPU.
+    //  The ranges are [start, end[ and can contain the character zero.
+    class StringSearch
+    {
+    public:
+        static void     Setup(const InitOptions & options);
+        static bool     IsUsingSSE2();
+
+        // Returns the first (or last) position of c in the range, NULL if not found
+        CROSSNET_FINLINE
+        static const ::System::Char *   FindChar(const ::System::Char * start, const ::System::Char * end, ::System::Char c)
+        {
+            return (sFindChar(start, end, c));
+        }
+        CROSSNET_FINLINE
+        static const ::System::Char *   FindLastChar(const ::System::Char * start, const ::System::Char * end, ::System::Char c)
+        {
+            return (sFindLastChar(start, end, c));
+        }
+
+        // Returns the first (or last) position of any character of the set in the range, NULL if not found
+        CROSSNET_FINLINE
+        static const ::System::Char *   FindAnyChar(const ::System::Char * start, const ::System::Char * end, const CharSet & set)
+        {
+            return (sFindAnyChar(start, end, set));
+        }
+        CROSSNET_FINLINE
+        static const ::System::Char *   FindLastAnyChar(const ::System::Char * start, const ::System::Char * end, const CharSet & set)
+        {
+            return (sFindLastAnyChar(start, end, set));
+        }
+
+        // White spaces are the same as String::Trim(): 0x09 to 0x0d and 0x20
+        //  Returns the first character that is not a white space, end if there are only white spaces
+        CROSSNET_FINLINE
+        static const ::System::Char *   SkipWhiteSpaces(const ::System::Char * start, const ::System::Char * end)
+        {
+            return (sSkipWhiteSpaces(start, end));
+        }
+        //  Returns the position just after the last character that is not a white space, start if there are only white spaces
+        CROSSNET_FINLINE
+        static const ::System::Char *   SkipLastWhiteSpaces(const ::System::Char * start, const ::System::Char * end)
+        {
+            return (sSkipLastWhiteSpaces(start, end));
+        }
+
+        // Returns the index of the first character that differs between a and b, length if they are the same
+        CROSSNET_FINLINE
+        static ::System::Int32          FindMismatch(const ::System::Char * a, const ::System::Char * b, ::System::Int32 length)
+        {
+            return (sFindMismatch(a, b, length));
+        }
+
+        // Returns the first (or last) position of the needle in the range, NULL if not found
+        //  Use a StringSearcher instead when the same needle is searched several times
+        static const ::System::Char *   FindString(const ::System::Char * start, const ::System::Char * end, const ::System::Char * needle, ::System::Int32 needleLength);
+        static const ::System::Char *   FindLastString(const ::System::Char * start, const ::System::Char * end, const ::System::Char * needle, ::System::Int32 needleLength);
+
+        CROSSNET_FINLINE
+        static bool IsWhiteSpace(::System::Char c)
+        {
+            unsigned int value = (unsigned int)c;
+            return ((value == 0x20) || ((value - 0x09) <= (0x0d - 0x09)));
+        }
+
+    private:
+        StringSearch();
+        StringSearch(const StringSearch & other);
+        ~StringSearch();
+        StringSearch & operator=(StringSearch & other);
+
+        typedef const ::System::Char * (*FindCharFunctionPointer)(const ::System::Char * start, const ::System::Char * end, ::System::Char c);
+        typedef const ::System::Char * (*FindAnyCharFunctionPointer)(const ::System::Char * start, const ::System::Char * end, const CharSet & set);
+        typedef const ::System::Char * (*SkipFunctionPointer)(const ::System::Char * start, const ::System::Char * end);
+        typedef ::System::Int32 (*FindMismatchFunctionPointer)(const ::System::Char * a, const ::System::Char * b, ::System::Int32 length);
+        typedef const ::System::Char * (*FindStringFunctionPointer)(const ::System::Char * start, const ::System::Char * end, const ::System::Char * needle, ::System::Int32 needleLength);
+
+        static FindCharFunctionPointer      sFindChar;
+        static FindCharFunctionPointer      sFindLastChar;
+        static FindAnyCharFunctionPointer   sFindAnyChar;
+        static FindAnyCharFunctionPointer   sFindLastAnyChar;
+        static SkipFunctionPointer          sSkipWhiteSpaces;
+        static SkipFunctionPointer          sSkipLastWhiteSpaces;
+        static FindMismatchFunctionPointer  sFindMismatch;
+        // Only for the needles that StringSearcher doesn't handle with the skip tables
+        static FindStringFunctionPointer    sFindShortString;
+        static FindStringFunctionPointer    sFindLastShortString;
+
+        friend class StringSearcher;
+    };
+
+    // Substring search for a given needle
+    //  The short needles are found by looking for their first and last characters (with SSE2 if available), then comparing the rest.
+    //  The longer needles use Boyer-Moore-Horspool, the skip tables are built once by the constructor.
+    //  The needle is not copied, it must stay valid as long as the searcher is used.
+    class StringSearcher
+    {
+    public:
+        StringSearcher(const ::System::Char * needle, ::System::Int32 needleLength);
+
+        // Returns the first (or last) position of the needle in the range, NULL if not found
+        //  An empty needle is found at the start (or the end) of the range
+        const ::System::Char *  Find(const ::System::Char * start, const ::System::Char * end) const;
+        const ::System::Char *  FindLast(const ::System::Char * start, const ::System::Char * end) const;
+
+        CROSSNET_FINLINE
+        ::System::Int32 GetNeedleLength() const
+        {
+            return (mNeedleLength);
+        }
+
+        // Needles longer than that use the skip tables
+        static const ::System::Int32    MAX_SHORT_NEEDLE_LENGTH = 32;
+
+    private:
+        const ::System::Char *  mNeedle;
+        ::System::Int32         mNeedleLength;
+        // Indexed by the low byte of the characters (characters with the same low byte use the smallest skip)
+        //  Only initialized for the long needles
+        ::System::Int32         mSkip[256];
+        ::System::Int32         mLastSkip[256];
+    };
+}
+
+#endif
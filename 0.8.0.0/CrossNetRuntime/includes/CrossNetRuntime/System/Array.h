@@ -26,6 +26,7 @@
 #include "CrossNetRuntime/System/Collections/Generic/IList__G1.h"
 #include "CrossNetRuntime/System/Collections/Generic/ICollection__G1.h"
 #include "CrossNetRuntime/GC/GCManager.h"
+#include "CrossNetRuntime/Internal/EnumeratorPool.h"
 #include "CrossNetRuntime/Internal/Tracer.h"
 #include "CrossNetRuntime/Internal/Typeof.h"
 
@@ -92,6 +93,9 @@ namespace System
         // So we can do some type safety, at the item level
         virtual void * * GetItemInterfaceMap() = 0;
 
+        // Gives an enumerator created by this array back to the enumerator pool (see CrossNetRuntime::ForEachScope)
+        virtual void __RecycleEnumerator__(System::Object * enumerator) = 0;
+
         Boolean get_IsFixedSize()
         {
             return (true);
@@ -288,7 +292,8 @@ namespace System
     class Array__G : public Array
     {
     public:
-        CN_MULTIPLE_DYNAMIC_OBJECT_ID
+        // When the items don't contain any reference, the array is flagged in the interface map and the GC doesn't look at the items
+        CN_MULTIPLE_DYNAMIC_OBJECT_ID_WITH_OFFSETS
         (
             sizeof(Array__G),
             __W7__
@@ -303,6 +308,8 @@ namespace System
             )
             ,
             NULL
+            ,
+            (::CrossNetRuntime::ContainsReferences<T>::Value ? NULL : ::CrossNetRuntime::NO_REFERENCE_OFFSETS)
         )
 
         static Array__G * __Create__(int first, T * initValues = NULL)
@@ -342,6 +349,14 @@ namespace System
             return (mItems);
         }
 
+        // Same as get_Length() but not virtual, and for any number of dimensions
+        //  Used by the loops generated for foreach, with SingleDimensionItem()
+        CROSSNET_FINLINE
+        int __GetNumItems__() const
+        {
+            return (GetSize());
+        }
+
         const T & Item(int first) const
         {
             CROSSNET_ASSERT(mSecond == 0, "This is not a one dimension array!");
@@ -619,6 +634,15 @@ namespace System
             return (CrossNetRuntime::GetInterfaceMap<T>());
         }
 
+        virtual void __RecycleEnumerator__(System::Object * enumerator)
+        {
+            // The enumerator might come from another array type (like with the array covariance)
+            if (enumerator->m__InterfaceMap__ == ArrayEnumerator::__GetInterfaceMap__())
+            {
+                static_cast<ArrayEnumerator *>(enumerator)->Recycle();
+            }
+        }
+
         class ArrayEnumerator : public System::Object
         {
         public:
@@ -635,22 +659,30 @@ namespace System
                 NULL
             )
 
-            ArrayEnumerator(Array__G * array)
-                :
-                mArray(array),
-                mIndex(-1)
+            // Reuses a disposed enumerator if possible
+            static ArrayEnumerator * __Create__(Array__G * array)
             {
-                m__InterfaceMap__ = __GetInterfaceMap__();
-                mSize = array->GetSize();
+                ArrayEnumerator * enumerator = ::CrossNetRuntime::EnumeratorPool<ArrayEnumerator>::Pop();
+                if (enumerator == NULL)
+                {
+                    enumerator = new ArrayEnumerator();
+                    enumerator->m__InterfaceMap__ = __GetInterfaceMap__();
+                }
+                enumerator->mArray = array;
+                enumerator->mIndex = -1;
+                enumerator->mSize = array->GetSize();
+                return (enumerator);
             }
 
             System::Object * get_Current()
             {
+                CROSSNET_ASSERT(mArray != NULL, "The enumerator has been disposed!");
                 return (CrossNetRuntime::Box<System::Object>(mArray->SingleDimensionItem(mIndex)));
             }
 
             T IEnumerator__G1__get_Current()
             {
+                CROSSNET_ASSERT(mArray != NULL, "The enumerator has been disposed!");
                 return (mArray->SingleDimensionItem(mIndex));
             }
 
@@ -667,7 +699,23 @@ namespace System
 
             void Dispose()
             {
-                // Do nothing...
+                // Release the array, MoveNext() returns false from now on
+                //  The enumerator is not given back to the pool here, the caller might still use it after Dispose()
+                mArray = NULL;
+                mIndex = 0;
+                mSize = 0;
+            }
+
+            // Only called by the foreach that created the enumerator, nobody else has a reference to it
+            void Recycle()
+            {
+                Dispose();
+                ::CrossNetRuntime::EnumeratorPool<ArrayEnumerator>::Push(this);
+            }
+
+            virtual void __Trace__(unsigned char currentMark)
+            {
+                ::CrossNetRuntime::GCManager::Trace(mArray, currentMark);
             }
 
             class ArrayEnumerator__IEnumerator : public System::Collections::IEnumerator
@@ -713,6 +761,15 @@ namespace System
             };
 
         private:
+            ArrayEnumerator()
+                :
+                mArray(NULL),
+                mIndex(-1),
+                mSize(0)
+            {
+                // Do nothing...
+            }
+
             Array__G *  mArray;
             Int32       mIndex;
             Int32       mSize;
@@ -720,12 +777,12 @@ namespace System
 
         System::Collections::IEnumerator * GetEnumerator()
         {
-            return (CrossNetRuntime::FastCast<System::Collections::IEnumerator>(new ArrayEnumerator(this)));
+            return (CrossNetRuntime::FastCast<System::Collections::IEnumerator>(ArrayEnumerator::__Create__(this)));
         }
 
         System::Collections::Generic::IEnumerator__G1<T> *  IEnumerator__G1__GetEnumerator()
         {
-            return (CrossNetRuntime::FastCast<System::Collections::Generic::IEnumerator__G1<T> >(new ArrayEnumerator(this)));
+            return (CrossNetRuntime::FastCast<System::Collections::Generic::IEnumerator__G1<T> >(ArrayEnumerator::__Create__(this)));
         }
 
         System::Object * Clone()
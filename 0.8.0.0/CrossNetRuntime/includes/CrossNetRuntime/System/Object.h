@@ -101,6 +101,24 @@ namespace System
         //      Will return NULL if the type can't be casted
         void * __Cast__(int iid);
 
+        // Same as __Cast__ but works directly on the interface map
+        //  This is used to cast value types without boxing them
+        static bool __CanCast__(void * * interfaceMap, int iid);
+
+        // Queries a type from the instance, with the interface map of the type instead of its ID
+        //  Casts to classes are done in constant time (see InterfaceMapper::IsSameOrSubclass)
+        CROSSNET_FINLINE
+        void * __Cast__(void * * targetInterfaceMap)
+        {
+            if (__CanCast__(m__InterfaceMap__, targetInterfaceMap))
+            {
+                return (this);
+            }
+            return (NULL);
+        }
+
+        static bool __CanCast__(void * * interfaceMap, void * * targetInterfaceMap);
+
         virtual System::String * ToString();
 
         virtual System::Boolean Equals(Object * other)
@@ -30,6 +30,7 @@ namespace CrossNetRuntime
     class PointerWrapper;
 
     class StringPooler;
+    class CharSet;
 
     template <typename T>
     class BaseTypeWrapper;
@@ -97,6 +98,9 @@ namespace System
         static String * Concat(System::Object * a, System::Object * b);
         static String * Concat(System::Object * a, System::Object * b, System::Object * c);
         static String * Concat(System::Object * a, System::Object * b, System::Object * c, System::Object * d);
+        // Concatenation of any number of strings, with a single allocation (NULL strings are considered empty)
+        //  This is what the parser generates for the C# concatenations (see CrossNetRuntime::StringConcat)
+        static String * __Concat__(const String * const * parts, System::Int32 count);
 
         static String * Format(String * /*a*/, Object * /*b*/);
         static String * Format(String * /*a*/, Object * /*b*/, Object * /*c*/);
@@ -142,11 +146,27 @@ namespace System
 
         static bool op_Equality(const String * a, const String * b)
         {
+            if (a == b)
+            {
+                // Same instance, or both NULL
+                return (true);
+            }
+            if ((a == NULL) || (b == NULL))
+            {
+                return (false);
+            }
             if (a->mLength != b->mLength)
             {
                 return (false);
             }
-            return (Compare(a, b) == 0);
+            // If both hash codes are already calculated, different hash codes mean different strings
+            System::Int32 hashCodeA = a->mHashCode;
+            System::Int32 hashCodeB = b->mHashCode;
+            if ((hashCodeA != 0) && (hashCodeB != 0) && (hashCodeA != hashCodeB))
+            {
+                return (false);
+            }
+            return (__EqualsChars__(a, b));
         }
 
         virtual System::Boolean Equals(System::Object * obj);
@@ -159,11 +179,7 @@ namespace System
 
         static System::Boolean op_Inequality(const String * a, const String * b)
         {
-            if (a->mLength != b->mLength)
-            {
-                return (true);
-            }
-            return (Compare(a, b) != 0);
+            return (op_Equality(a, b) == false);
         }
 
         static System::Int32 Compare(const String * a, const String * b, System::Boolean ignoreCase);
@@ -282,7 +298,19 @@ namespace System
         static String * __CreateEmpty__();
 
         // Specific version where the size of the string is known
-        static String * __CreateWithLengthKnown__(System::Char * text, System::Int32 length);
+        static String * __CreateWithLengthKnown__(const System::Char * text, System::Int32 length);
+
+        // Compares the characters of two strings of the same length (the embedded zeros are compared as well)
+        static bool __EqualsChars__(const String * a, const String * b);
+        // Ordinal comparison of two ranges of characters
+        static System::Int32 CompareOrdinal(const System::Char * a, System::Int32 lengthA, const System::Char * b, System::Int32 lengthB);
+
+        // Returns the part of the string between start and end (end not included), or this if that's the whole string
+        String * __SubString__(const System::Char * start, const System::Char * end);
+
+        // Skip the characters of the set, forward from start or backward from end
+        static const System::Char * SkipChars(const System::Char * start, const System::Char * end, const CrossNetRuntime::CharSet & set);
+        static const System::Char * SkipLastChars(const System::Char * start, const System::Char * end, const CrossNetRuntime::CharSet & set);
 
         class Wrapper__IComparable : public IComparable
         {
@@ -17,6 +17,7 @@
 #define __SYSTEM_TEXT_STRINGBUILDER_H__
 
 #include "CrossNetRuntime/System/Delegate.h"
+#include "CrossNetRuntime/System/String.h"
 #include <vector>
 
 namespace System
@@ -103,13 +104,30 @@ namespace System
 
         private:
             StringBuilder();
-            void    Reserve(System::Int32 newSize);
+            // Makes room for numChars more characters at the end and returns where to write them
+            //  The characters are counted in the length right away, the caller has to write all of them
+            System::Char *  AppendUninitialized(System::Int32 numChars);
+            // The buffer can be modified in place after this call
+            System::Char *  GetWritableBuffer();
+            void            Reserve(System::Int32 newSize);
+            void            Grow(System::Int32 newSize);
+            StringBuilder * AppendChars(const System::Char * text, System::Int32 length);
+            StringBuilder * AppendUnsigned(System::UInt32 value, bool negative);
+            StringBuilder * AppendUnsigned(System::UInt64 value, bool negative);
+
+            CROSSNET_FINLINE
+            System::Int32 GetCapacity() const
+            {
+                return ((mBuffer != NULL) ? mBuffer->mLength : 0);
+            }
 
             static const int MIN_CAPACITY = 16;
 
-            System::Char *  mBuffer;
-            System::Int32   mSize;
-            System::Int32   mCapacity;
+            // The characters are stored in a string allocated on the GC heap, its length is the capacity
+            //  ToString() gives this string away without copying it, the next modification copies it first
+            System::String *    mBuffer;
+            System::Int32       mSize;
+            System::Boolean     mShared;
         };
     }
 }
@@ -0,0 +1,412 @@
+/*
+    CrossNet - Copyright (c) 2007 Olivier Nallet
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+    OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "CrossNetRuntime/CompositeFormat.h"
+#include "CrossNetRuntime/Assert.h"
+#include "CrossNetRuntime/StringPooler.h"
+#include "CrossNetRuntime/GC/GCManager.h"
+#include "CrossNetRuntime/Internal/BaseTypes.h"
+#include "CrossNetRuntime/Internal/Box.h"
+#include "CrossNetRuntime/System/IFormattable.h"
+#include "CrossNetRuntime/System/String.h"
+#include "CrossNetRuntime/System/Text/StringBuilder.h"
+
+namespace CrossNetRuntime
+{
+
+CompositeFormat *   CompositeFormat::sCache[CompositeFormat::CACHE_SIZE];
+int                 CompositeFormat::sNumAppending = 0;
+
+// Registered the first time a format is cached
+static GCManager::TraceHook sHook = { NULL, NULL };
+
+CROSSNET_FINLINE
+static bool IsDigit(::System::Char c)
+{
+    return ((unsigned int)(c - '0') <= 9);
+}
+
+CROSSNET_FINLINE
+static ::System::Int32 SkipSpaces(const ::System::Char * text, ::System::Int32 position, ::System::Int32 length)
+{
+    while ((position < length) && (text[position] == ' '))
+    {
+        ++position;
+    }
+    return (position);
+}
+
+// Writes the boxed value directly if the instance is of type T
+template <typename T>
+CROSSNET_FINLINE
+static bool AppendBoxed(::System::Text::StringBuilder * builder, ::System::Object * arg)
+{
+    if (arg->m__InterfaceMap__ != BaseTypeWrapper<T>::__GetInterfaceMap__())
+    {
+        return (false);
+    }
+    T value = static_cast<BoxedObject<BaseTypeWrapper<T> > *>(arg)->get_Value();
+    builder->Append(value);
+    return (true);
+}
+
+static void AppendArgument(::System::Text::StringBuilder * builder, ::System::Object * arg, ::System::String * formatSpecifier, ::System::IFormatProvider * provider)
+{
+    if (arg == NULL)
+    {
+        // Same as .NET, a null argument is an empty string
+        return;
+    }
+
+    if (formatSpecifier == NULL)
+    {
+        // The most common arguments don't need a temporary string
+        if (arg->m__InterfaceMap__ == ::System::String::__GetInterfaceMap__())
+        {
+            builder->Append(static_cast<::System::String *>(arg));
+            return;
+        }
+        if (AppendBoxed<::System::Int32>(builder, arg) || AppendBoxed<::System::UInt32>(builder, arg)
+            || AppendBoxed<::System::Int64>(builder, arg) || AppendBoxed<::System::UInt64>(builder, arg)
+            || AppendBoxed<::System::Boolean>(builder, arg) || AppendBoxed<::System::Char>(builder, arg))
+        {
+            return;
+        }
+    }
+    else if (arg->__Cast__(::System::IFormattable::__GetInterfaceMap__()) != NULL)
+    {
+        ::System::IFormattable * formattable = static_cast<::System::IFormattable *>(arg->m__InterfaceMap__[::System::IFormattable::__GetId__()]);
+        builder->Append(formattable->ToString(arg, formatSpecifier, provider));
+        return;
+    }
+    builder->Append(arg->ToString());
+}
+
+// Counts the appends in progress for the lifetime of the scope
+//  The count is decremented by the destructor, so it is still correct if a ToString() of an argument throws
+class AppendingScope
+{
+public:
+    CROSSNET_FINLINE
+    explicit AppendingScope(int * numAppending)
+        :
+        mNumAppending(numAppending)
+    {
+        ++(*mNumAppending);
+    }
+
+    CROSSNET_FINLINE
+    ~AppendingScope()
+    {
+        --(*mNumAppending);
+    }
+
+private:
+    // Declared but not implemented on purpose, the count must be decremented only once
+    AppendingScope(const AppendingScope & other);
+    AppendingScope & operator=(const AppendingScope & other);
+
+    int *   mNumAppending;
+};
+
+void CompositeFormat::Append(::System::Text::StringBuilder * builder, ::System::IFormatProvider * provider, ::System::String * format,
+                                ::System::Object * const * args, ::System::Int32 numArgs)
+{
+    CROSSNET_ASSERT(format != NULL, "The format can't be NULL!");
+
+    // Look for the format in the cache
+    //  An eviction replaces the format in the same slot, so the slots are only freed by Teardown()
+    //  The search can stop at the first free slot
+    int index = GetCacheIndex(format);
+    int coldestIndex = -1;
+    for (int i = 0 ; i < CACHE_PROBES ; ++i)
+    {
+        int currentIndex = (index + i) & (CACHE_SIZE - 1);
+        CompositeFormat * compositeFormat = sCache[currentIndex];
+        if (compositeFormat == NULL)
+        {
+            Insert(currentIndex, format);
+            coldestIndex = currentIndex;
+            break;
+        }
+        if (compositeFormat->mFormat == format)
+        {
+            if (compositeFormat->mUseCount < MAX_USE_COUNT)
+            {
+                ++compositeFormat->mUseCount;
+            }
+            coldestIndex = currentIndex;
+            break;
+        }
+        if ((coldestIndex < 0) || (compositeFormat->mUseCount < sCache[coldestIndex]->mUseCount))
+        {
+            coldestIndex = currentIndex;
+        }
+    }
+
+    if (sCache[coldestIndex]->mFormat != format)
+    {
+        if (sNumAppending != 0)
+        {
+            // Nested call (from a ToString() of an argument), the evicted format could be the one being appended
+            //  Parse it just for this call
+            CompositeFormat compositeFormat(format);
+            compositeFormat.AppendTo(builder, provider, args, numArgs);
+            return;
+        }
+
+        // The least used format is replaced, the others get older
+        for (int i = 0 ; i < CACHE_PROBES ; ++i)
+        {
+            sCache[(index + i) & (CACHE_SIZE - 1)]->mUseCount >>= 1;
+        }
+        delete sCache[coldestIndex];
+        Insert(coldestIndex, format);
+    }
+
+    AppendingScope appendingScope(&sNumAppending);
+    sCache[coldestIndex]->AppendTo(builder, provider, args, numArgs);
+}
+
+void CompositeFormat::Insert(int index, ::System::String * format)
+{
+    sCache[index] = new CompositeFormat(format);
+    if (sHook.mTrace == NULL)
+    {
+        sHook.mTrace = &Trace;
+        GCManager::RegisterTraceHook(&sHook);
+    }
+}
+
+void CompositeFormat::Teardown()
+{
+    for (int i = 0 ; i < CACHE_SIZE ; ++i)
+    {
+        delete sCache[i];
+        sCache[i] = NULL;
+    }
+}
+
+void CompositeFormat::Trace(unsigned char currentMark)
+{
+    // Keep the cached formats alive, otherwise another string could be allocated at the same address
+    //  Once evicted, a format is not traced anymore
+    for (int i = 0 ; i < CACHE_SIZE ; ++i)
+    {
+        if (sCache[i] != NULL)
+        {
+            GCManager::Trace(sCache[i]->mFormat, currentMark);
+        }
+    }
+}
+
+CompositeFormat::CompositeFormat(::System::String * format)
+    :
+    mFormat(format),
+    mUseCount(1)
+{
+    Parse();
+}
+
+void CompositeFormat::Parse()
+{
+    const ::System::Char * text = mFormat->__ToCString__();
+    ::System::Int32 length = mFormat->get_Length();
+    ::System::Int32 literalStart = 0;
+    ::System::Int32 position = 0;
+    while (position < length)
+    {
+        ::System::Char c = text[position];
+        if ((c != '{') && (c != '}'))
+        {
+            ++position;
+            continue;
+        }
+        if ((position + 1 < length) && (text[position + 1] == c))
+        {
+            // Escaped brace, the literal stops just after the first one and restarts after the second one
+            AddToken(literalStart, position + 1, -1, 0, NULL);
+            position += 2;
+            literalStart = position;
+            continue;
+        }
+        if (c == '}')
+        {
+            CROSSNET_ASSERT(false, "Unexpected '}' in the format!");
+            break;
+        }
+
+        ::System::Int32 next = ParseArgument(text, position + 1, length, literalStart, position);
+        if (next < 0)
+        {
+            CROSSNET_ASSERT(false, "Incorrect format item!");
+            break;
+        }
+        position = next;
+        literalStart = position;
+    }
+
+    // The remaining text (the end of the format or what couldn't be parsed) is kept as is
+    if (literalStart < length)
+    {
+        AddToken(literalStart, length, -1, 0, NULL);
+    }
+}
+
+::System::Int32 CompositeFormat::ParseArgument(const ::System::Char * text, ::System::Int32 position, ::System::Int32 length,
+                                                ::System::Int32 literalStart, ::System::Int32 literalEnd)
+{
+    if ((position >= length) || (IsDigit(text[position]) == false))
+    {
+        return (-1);
+    }
+    ::System::Int32 argIndex = 0;
+    while ((position < length) && IsDigit(text[position]))
+    {
+        argIndex = (argIndex * 10) + (text[position++] - '0');
+        if (argIndex >= MAX_INDEX)
+        {
+            return (-1);
+        }
+    }
+    position = SkipSpaces(text, position, length);
+
+    ::System::Int32 alignment = 0;
+    if ((position < length) && (text[position] == ','))
+    {
+        position = SkipSpaces(text, position + 1, length);
+        bool leftAligned = false;
+        if ((position < length) && (text[position] == '-'))
+        {
+            leftAligned = true;
+            ++position;
+        }
+        if ((position >= length) || (IsDigit(text[position]) == false))
+        {
+            return (-1);
+        }
+        while ((position < length) && IsDigit(text[position]))
+        {
+            alignment = (alignment * 10) + (text[position++] - '0');
+            if (alignment >= MAX_INDEX)
+            {
+                return (-1);
+            }
+        }
+        position = SkipSpaces(text, position, length);
+        if (leftAligned)
+        {
+            alignment = -alignment;
+        }
+    }
+
+    ::System::String * formatSpecifier = NULL;
+    if ((position < length) && (text[position] == ':'))
+    {
+        ::System::Int32 specifierStart = ++position;
+        while ((position < length) && (text[position] != '}'))
+        {
+            if (text[position] == '{')
+            {
+                return (-1);
+            }
+            ++position;
+        }
+        if (position > specifierStart)
+        {
+            // Pooled so the specifier is shared between the formats and stays alive
+            formatSpecifier = StringPooler::GetOrCreateString(text + specifierStart, position - specifierStart);
+        }
+    }
+
+    if ((position >= length) || (text[position] != '}'))
+    {
+        return (-1);
+    }
+    AddToken(literalStart, literalEnd, argIndex, alignment, formatSpecifier);
+    return (position + 1);
+}
+
+void CompositeFormat::AddToken(::System::Int32 literalStart, ::System::Int32 literalEnd, ::System::Int32 argIndex,
+                                ::System::Int32 alignment, ::System::String * formatSpecifier)
+{
+    if ((literalStart == literalEnd) && (argIndex < 0))
+    {
+        return;
+    }
+    Token token;
+    token.mLiteralStart = literalStart;
+    token.mLiteralLength = literalEnd - literalStart;
+    token.mArgIndex = argIndex;
+    token.mAlignment = alignment;
+    token.mFormatSpecifier = formatSpecifier;
+    mTokens.push_back(token);
+}
+
+void CompositeFormat::AppendTo(::System::Text::StringBuilder * builder, ::System::IFormatProvider * provider,
+                                ::System::Object * const * args, ::System::Int32 numArgs) const
+{
+    const Token * token = mTokens.empty() ? NULL : &mTokens[0];
+    const Token * end = token + mTokens.size();
+    for ( ; token != end ; ++token)
+    {
+        if (token->mLiteralLength != 0)
+        {
+            builder->Append(mFormat, token->mLiteralStart, token->mLiteralLength);
+        }
+        if (token->mArgIndex < 0)
+        {
+            continue;
+        }
+        if (token->mArgIndex >= numArgs)
+        {
+            CROSSNET_ASSERT(false, "The index of the format item is out of range!");
+            continue;
+        }
+
+        ::System::Int32 start = builder->get_Length();
+        AppendArgument(builder, args[token->mArgIndex], token->mFormatSpecifier, provider);
+        if (token->mAlignment == 0)
+        {
+            continue;
+        }
+        ::System::Int32 width = (token->mAlignment > 0) ? token->mAlignment : -token->mAlignment;
+        ::System::Int32 padding = width - (builder->get_Length() - start);
+        if (padding <= 0)
+        {
+            continue;
+        }
+        if (token->mAlignment > 0)
+        {
+            // Right aligned, the spaces go before the argument
+            builder->Insert(start, StringPooler::GetOrCreateString(CROSSNET_TEXT(" ")), padding);
+        }
+        else
+        {
+            builder->Append((::System::Char)' ', padding);
+        }
+    }
+}
+
+int CompositeFormat::GetCacheIndex(::System::String * format)
+{
+    // The GC allocations are aligned on 16 bytes, the lower bits don't carry any information
+    size_t key = (size_t)format;
+    key ^= key >> 12;
+    return ((int)(key >> 4) & (CACHE_SIZE - 1));
+}
+
+}
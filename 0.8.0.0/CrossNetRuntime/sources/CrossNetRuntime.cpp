@@ -14,6 +14,9 @@
 */
 
 #include "CrossNetRuntime/CrossNetRuntime.h"
+#include "CrossNetRuntime/CompositeFormat.h"
+#include "CrossNetRuntime/Number.h"
+#include "CrossNetRuntime/StringSearch.h"
 #include "CrossNetRuntime/System/IDisposable.h"
 #include "CrossNetRuntime/System/Delegate.h"
 #include "CrossNetRuntime/System/MulticastDelegate.h"
@@ -22,6 +25,8 @@
 #include "CrossNetRuntime/Internal/Box.h"
 #include "CrossNetRuntime/Internal/__Math__.h"
 #include <math.h>
+// For _umul128
+#include <intrin.h>
 
 CrossNetRuntime::InitOptions CrossNetRuntime::InitOptions::sOptions;
 
@@ -100,6 +105,11 @@ void CrossNetRuntime__PopulateInterfaceMaps()
     CrossNetRuntime::BaseTypeWrapper<System::Double>::__RegisterId__();
     CrossNetRuntime::BaseTypeWrapper<System::Decimal>::__RegisterId__();
 
+    // The shared boxes need the interface maps of the base types
+    CrossNetRuntime::BoxCache<CrossNetRuntime::BaseTypeWrapper<System::Boolean> >::Setup();
+    CrossNetRuntime::BoxCache<CrossNetRuntime::BaseTypeWrapper<System::Char> >::Setup();
+    CrossNetRuntime::BoxCache<CrossNetRuntime::BaseTypeWrapper<System::Int32> >::Setup();
+
     // Then more complex base types
     System::Delegate::__RegisterId__();
     System::MulticastDelegate::__RegisterId__();
@@ -120,8 +130,8 @@ void CrossNetRuntime::BaseTypeWrapper<System::Boolean>::__RegisterId__()
     };
     s__InterfaceMap__ = CrossNetRuntime::InterfaceMapper::RegisterObject(sizeof(CrossNetRuntime::BoxedObject<CrossNetRuntime::BaseTypeWrapper<System::Boolean> >), info, sizeof(info) / sizeof(info[0]), NULL);
 
-    FalseString = ::CrossNetRuntime::StringPooler::GetOrCreateString(L"False");
-    TrueString = ::CrossNetRuntime::StringPooler::GetOrCreateString(L"True");
+    FalseString = ::CrossNetRuntime::StringPooler::GetOrCreateString(CROSSNET_TEXT("False"));
+    TrueString = ::CrossNetRuntime::StringPooler::GetOrCreateString(CROSSNET_TEXT("True"));
 }
 
 #define IMPLEMENT_REGISTER_ID(type)                                                 \
@@ -151,114 +161,229 @@ IMPLEMENT_REGISTER_ID(::System::Single)
 IMPLEMENT_REGISTER_ID(::System::Double)
 IMPLEMENT_REGISTER_ID(::System::Decimal)
 
-//template <>       //  The class is already specialized, so we just need to define the method (don't define it as specialized)
-                    //  Also because that's a specialization, if it is not inlined, this should not be defined in a header...
-System::String * CrossNetRuntime::BaseTypeWrapper<System::Int32>::ToString(System::String * format)
+// Creates the shared boxes for consecutive values
+//  The buffer is static memory, so it is not part of the GC allocation space and it is never swept
+template <typename T>
+static void CreatePermanentBoxes(System::Object * * boxes, unsigned char * buffer, int first, int numBoxes)
 {
-    // Partially supported... Currently only so the unit-test can run...
-    const System::Char * buffer = format->__ToCString__();
-    if (format->get_Length() == 1)
+    typedef CrossNetRuntime::BoxedObject<CrossNetRuntime::BaseTypeWrapper<T> > BoxedType;
+    for (int i = 0 ; i < numBoxes ; ++i)
     {
-        System::Char  text[16];
-        if (buffer[0] == L'X')
-        {
-            _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%X", mValue);
-            return (System::String::__Create__(text));
-        }
-        else if (buffer[0] == L'x')
-        {
-            _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%x", mValue);
-            return (System::String::__Create__(text));
-        }
+        boxes[i] = BoxedType::__CreatePermanent__(buffer, CrossNetRuntime::BaseTypeWrapper<T>((T)(first + i)));
+        buffer += sizeof(BoxedType);
     }
-    return (ToString());
 }
 
-System::String * CrossNetRuntime::BaseTypeWrapper<System::Char>::ToString(System::String * /*format*/, System::IFormatProvider * /*formatProvider*/)
+System::Object * CrossNetRuntime::BoxCache<CrossNetRuntime::BaseTypeWrapper<System::Boolean> >::sBoxes[NUM_BOXES];
+System::Object * CrossNetRuntime::BoxCache<CrossNetRuntime::BaseTypeWrapper<System::Char> >::sBoxes[NUM_BOXES];
+System::Object * CrossNetRuntime::BoxCache<CrossNetRuntime::BaseTypeWrapper<System::Int32> >::sBoxes[NUM_BOXES];
+
+void CrossNetRuntime::BoxCache<CrossNetRuntime::BaseTypeWrapper<System::Boolean> >::Setup()
 {
-    CROSSNET_NOT_IMPLEMENTED();
-    return (NULL);
+    typedef CrossNetRuntime::BoxedObject<CrossNetRuntime::BaseTypeWrapper<System::Boolean> > BoxedType;
+    static __declspec(align(16)) unsigned char sBuffer[NUM_BOXES * sizeof(BoxedType)];
+    // Don't use CreatePermanentBoxes() here, casting an int to bool triggers a warning
+    sBoxes[0] = BoxedType::__CreatePermanent__(sBuffer, CrossNetRuntime::BaseTypeWrapper<System::Boolean>(false));
+    sBoxes[1] = BoxedType::__CreatePermanent__(sBuffer + sizeof(BoxedType), CrossNetRuntime::BaseTypeWrapper<System::Boolean>(true));
 }
 
-System::Double CrossNetRuntime::__Math__::Modulo(System::Double a, System::Double b)
+void CrossNetRuntime::BoxCache<CrossNetRuntime::BaseTypeWrapper<System::Char> >::Setup()
 {
-    // Something like that...
-    double  f = a / b;
-    f = floor(f) * b;
-    return (a - f);
+    typedef CrossNetRuntime::BoxedObject<CrossNetRuntime::BaseTypeWrapper<System::Char> > BoxedType;
+    static __declspec(align(16)) unsigned char sBuffer[NUM_BOXES * sizeof(BoxedType)];
+    CreatePermanentBoxes<System::Char>(sBoxes, sBuffer, FIRST, NUM_BOXES);
 }
 
-System::Int32 CrossNetRuntime::BaseTypeWrapper<System::Int32>::Parse(System::String * value)
+void CrossNetRuntime::BoxCache<CrossNetRuntime::BaseTypeWrapper<System::Int32> >::Setup()
 {
-    int integer = _wtoi(value->__ToCString__());
-    // Currently this code doesn't handle exceptions correctly if the conversion is incorrect...
-    // TODO:    Manage exceptions accordingly...
-    return (integer);
+    typedef CrossNetRuntime::BoxedObject<CrossNetRuntime::BaseTypeWrapper<System::Int32> > BoxedType;
+    static __declspec(align(16)) unsigned char sBuffer[NUM_BOXES * sizeof(BoxedType)];
+    CreatePermanentBoxes<System::Int32>(sBoxes, sBuffer, FIRST, NUM_BOXES);
 }
 
-System::Int16 CrossNetRuntime::BaseTypeWrapper<System::Int16>::Parse(System::String * value)
+// The integers are parsed as 64 bits integers, then checked against the range of their type
+template <typename T>
+static System::Boolean TryParseSigned(System::String * value, T * result)
 {
-    int integer = _wtoi(value->__ToCString__());
-    // Currently this code doesn't handle exceptions correctly if the conversion is incorrect...
-    // TODO:    Manage exceptions accordingly...
-    return (System::Int16)(integer);
+    System::Int64 number;
+    if ((value == NULL) || (CrossNetRuntime::Number::TryParse(value->__ToCString__(), value->get_Length(),
+                                CrossNetRuntime::BaseTypeWrapper<T>::MinValue, CrossNetRuntime::BaseTypeWrapper<T>::MaxValue, &number) == false))
+    {
+        *result = 0;
+        return (false);
+    }
+    *result = (T)number;
+    return (true);
 }
 
-System::UInt16 CrossNetRuntime::BaseTypeWrapper<System::UInt16>::Parse(System::String * value)
+template <typename T>
+static System::Boolean TryParseUnsigned(System::String * value, T * result)
 {
-    int integer = _wtoi(value->__ToCString__());
-    // Currently this code doesn't handle exceptions correctly if the conversion is incorrect...
-    // TODO:    Manage exceptions accordingly...
-    return (System::UInt16)(integer);
+    System::UInt64 number;
+    if ((value == NULL) || (CrossNetRuntime::Number::TryParse(value->__ToCString__(), value->get_Length(),
+                                CrossNetRuntime::BaseTypeWrapper<T>::MaxValue, &number) == false))
+    {
+        *result = 0;
+        return (false);
+    }
+    *result = (T)number;
+    return (true);
 }
 
-System::Decimal CrossNetRuntime::BaseTypeWrapper<System::Decimal>::Parse(System::String * value, System::IFormatProvider * /* formatProvider */)
+template <typename T>
+static System::Boolean TryParseFloatingPoint(System::String * value, T * result)
+{
+    // Number has an overload for each floating point type, so Single is rounded only once
+    if ((value == NULL) || (CrossNetRuntime::Number::TryParse(value->__ToCString__(), value->get_Length(), result) == false))
+    {
+        *result = 0;
+        return (false);
+    }
+    return (true);
+}
+
+// There is no exception in the runtime, so Parse() asserts when the string is not a number (or the number is out of range)
+//  The result is 0 in that case
+#define IMPLEMENT_PARSE(type, tryParseFunction)                                                     \
+    type CrossNetRuntime::BaseTypeWrapper<type>::Parse(System::String * value)                      \
+    {                                                                                               \
+        type result;                                                                                \
+        if (tryParseFunction(value, &result) == false)                                              \
+        {                                                                                           \
+            CROSSNET_ASSERT(false, "The string is not a valid number!");                            \
+        }                                                                                           \
+        return (result);                                                                            \
+    }                                                                                               \
+    System::Boolean CrossNetRuntime::BaseTypeWrapper<type>::TryParse(System::String * value, type * result)    \
+    {                                                                                               \
+        return (tryParseFunction(value, result));                                                   \
+    }
+
+IMPLEMENT_PARSE(System::SByte, TryParseSigned)
+IMPLEMENT_PARSE(System::Int16, TryParseSigned)
+IMPLEMENT_PARSE(System::Int32, TryParseSigned)
+IMPLEMENT_PARSE(System::Int64, TryParseSigned)
+IMPLEMENT_PARSE(System::Byte, TryParseUnsigned)
+IMPLEMENT_PARSE(System::UInt16, TryParseUnsigned)
+IMPLEMENT_PARSE(System::UInt32, TryParseUnsigned)
+IMPLEMENT_PARSE(System::UInt64, TryParseUnsigned)
+IMPLEMENT_PARSE(System::Single, TryParseFloatingPoint)
+IMPLEMENT_PARSE(System::Double, TryParseFloatingPoint)
+
+//template <>       //  The class is already specialized, so we just need to define the method (don't define it as specialized)
+                    //  Also because that's a specialization, if it is not inlined, this should not be defined in a header...
+System::String * CrossNetRuntime::BaseTypeWrapper<System::Int32>::ToString(System::String * format)
 {
-    double d = _wtof(value->__ToCString__());
-    // Currently this code doesn't handle exceptions correctly if the conversion is incorrect...
-    // TODO:    Manage exceptions accordingly...
-    return (d);
+    // Partially supported ("D" and "X" only, see Number)
+    return (CrossNetRuntime::Number::ToString((System::Int64)mValue, format, 32));
 }
 
-// If you change this code, make sure that the parser is updated accoordingly...
-// And the other way around too
-//  Search for CppUtil.GetStringHashCode in CrossNet assembly
-System::Int32 CrossNetRuntime::GetHashCode(void * bufferToCrc, System::Int32 length)
+System::String * CrossNetRuntime::BaseTypeWrapper<System::Char>::ToString(System::String * /*format*/, System::IFormatProvider * /*formatProvider*/)
+{
+    CROSSNET_NOT_IMPLEMENTED();
+    return (NULL);
+}
+
+System::Double CrossNetRuntime::__Math__::Modulo(System::Double a, System::Double b)
 {
-    // The assumption is that the hashcode is calculated during parsing with FNV1
-    // We certainly want to implement a simpler / faster algorithm with some other optimizations... like loop unrolling, etc...
-    const System::UInt32    OFFSET_BASIS = 2166136261;
-    const System::UInt32    FNV_PRIME = 16777619;
+    // Something like that...
+    double  f = a / b;
+    f = floor(f) * b;
+    return (a - f);
+}
 
-    System::UInt32 hashCode = OFFSET_BASIS;
-    char * buffer = (char *)bufferToCrc;
-    char * endBuffer = buffer + length;
-    while (buffer < endBuffer)
+System::Decimal CrossNetRuntime::BaseTypeWrapper<System::Decimal>::Parse(System::String * value)
+{
+    // The decimals are stored as doubles
+    System::Double result;
+    if (TryParseFloatingPoint(value, &result) == false)
     {
-        hashCode ^= (System::UInt32)(*buffer++);
-        System::UInt64 result = (System::UInt64)hashCode * (System::UInt64)FNV_PRIME;
-        hashCode = (System::UInt32)result;
+        CROSSNET_ASSERT(false, "The string is not a valid number!");
     }
-    return (System::Int32)(hashCode);
+    return (result);
 }
 
-System::Int32 CrossNetRuntime::GetHashCodeForString(::System::Char * textToCrc, System::Int32 length)
+System::Decimal CrossNetRuntime::BaseTypeWrapper<System::Decimal>::Parse(System::String * value, System::IFormatProvider * /* formatProvider */)
 {
-    // The assumption is that the hashcode is calculated during parsing with FNV1
-    // We certainly want to implement a simpler / faster algorithm with some other optimizations... like loop unrolling, etc...
-    const System::UInt32    OFFSET_BASIS = 2166136261;
-    const System::UInt32    FNV_PRIME = 16777619;
-
-    System::UInt32 hashCode = OFFSET_BASIS;
-    System::Char * buffer = textToCrc;
-    System::Char * endBuffer = buffer + length;
-    while (buffer < endBuffer)
+    return (Parse(value));
+}
+
+// Multiply-mix hash (same family as wyhash)
+//  The buffer is read 8 bytes at a time (little endian), 32 bytes per step in the main loop with two independent multiplications.
+//  The last 1 to 7 bytes are read as a zero padded 8 bytes word.
+static const System::UInt64 HASH_P0 = 0xa0761d6478bd642fULL;
+static const System::UInt64 HASH_P1 = 0xe7037ed1a0b428dbULL;
+static const System::UInt64 HASH_P2 = 0x8ebc6af09c88c6e3ULL;
+static const System::UInt64 HASH_P3 = 0x589965cc75374cc3ULL;
+
+// Returns the low and the high parts of the 128 bits product, xored
+CROSSNET_FINLINE
+static System::UInt64 HashMix(System::UInt64 a, System::UInt64 b)
+{
+#if defined(_M_X64)
+    System::UInt64 high;
+    System::UInt64 low = _umul128(a, b, &high);
+    return (low ^ high);
+#else
+    // With 32 bits x 32 bits multiplications
+    System::UInt64 aLow = a & 0xffffffff;
+    System::UInt64 aHigh = a >> 32;
+    System::UInt64 bLow = b & 0xffffffff;
+    System::UInt64 bHigh = b >> 32;
+    System::UInt64 lowLow = aLow * bLow;
+    System::UInt64 lowHigh = aLow * bHigh;
+    System::UInt64 highLow = aHigh * bLow;
+    System::UInt64 highHigh = aHigh * bHigh;
+    System::UInt64 middle = (lowLow >> 32) + (lowHigh & 0xffffffff) + (highLow & 0xffffffff);
+    System::UInt64 low = (middle << 32) | (lowLow & 0xffffffff);
+    System::UInt64 high = highHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+    return (low ^ high);
+#endif
+}
+
+CROSSNET_FINLINE
+static System::UInt64 HashRead(const unsigned char * buffer)
+{
+    System::UInt64 value;
+    __memcopy__(&value, buffer, sizeof(value));
+    return (value);
+}
+
+static System::Int32 HashBytes(const unsigned char * buffer, System::Int32 length)
+{
+    System::UInt64 hashCode = HASH_P0;
+    System::Int32 remaining = length;
+    while (remaining >= 32)
+    {
+        hashCode = HashMix(HashRead(buffer) ^ HASH_P1, HashRead(buffer + 8) ^ hashCode)
+                    ^ HashMix(HashRead(buffer + 16) ^ HASH_P2, HashRead(buffer + 24) ^ hashCode);
+        buffer += 32;
+        remaining -= 32;
+    }
+    while (remaining >= 8)
     {
-        hashCode ^= (System::UInt32)(*buffer++);
-        System::UInt64 result = (System::UInt64)hashCode * (System::UInt64)FNV_PRIME;
-        hashCode = (System::UInt32)result;
+        hashCode = HashMix(HashRead(buffer) ^ HASH_P1, hashCode ^ HASH_P2);
+        buffer += 8;
+        remaining -= 8;
     }
-    return (System::Int32)(hashCode);
+    if (remaining > 0)
+    {
+        System::UInt64 last = 0;
+        __memcopy__(&last, buffer, remaining);
+        hashCode = HashMix(last ^ HASH_P3, hashCode ^ HASH_P1);
+    }
+    hashCode = HashMix(hashCode ^ (System::UInt64)length, HASH_P0 ^ HASH_P3);
+    return ((System::Int32)(System::UInt32)(hashCode ^ (hashCode >> 32)));
+}
+
+System::Int32 CrossNetRuntime::GetHashCode(void * bufferToCrc, System::Int32 length)
+{
+    return (HashBytes((const unsigned char *)bufferToCrc, length));
+}
+
+System::Int32 CrossNetRuntime::GetHashCodeForString(const ::System::Char * textToCrc, System::Int32 length)
+{
+    return (HashBytes((const unsigned char *)textToCrc, length * (System::Int32)sizeof(::System::Char)));
 }
 
 void CrossNetRuntime::Setup(const CrossNetRuntime::InitOptions & options)
@@ -268,12 +393,14 @@ void CrossNetRuntime::Setup(const CrossNetRuntime::InitOptions & options)
     CrossNetRuntime::GCAllocator::Setup(options);
     CrossNetRuntime::GCManager::Setup(options);
     CrossNetRuntime::InterfaceMapper::Setup(options);
+    CrossNetRuntime::StringSearch::Setup(options);
 
     CrossNetRuntime__PopulateInterfaceMaps();
 }
 
 void CrossNetRuntime::Teardown()
 {
+    CrossNetRuntime::CompositeFormat::Teardown();
     CrossNetRuntime::InterfaceMapper::Teardown();
     CrossNetRuntime::GCManager::Teardown();
     CrossNetRuntime::GCAllocator::Teardown();
@@ -311,16 +438,12 @@ System::String * CrossNetRuntime::BaseTypeWrapper<System::Boolean>::ToString()
 
 System::String * CrossNetRuntime::BaseTypeWrapper<System::Byte>::ToString()
 {
-    System::Char  text[16];
-    _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%c", mValue);
-    return (System::String::__Create__(text));
+    return (CrossNetRuntime::Number::ToString((System::UInt32)mValue));
 }
 
 System::String * CrossNetRuntime::BaseTypeWrapper<System::SByte>::ToString()
 {
-    System::Char  text[16];
-    _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%c", mValue);
-    return (System::String::__Create__(text));
+    return (CrossNetRuntime::Number::ToString((System::Int32)mValue));
 }
 
 System::String * CrossNetRuntime::BaseTypeWrapper<System::Char>::ToString()
@@ -335,99 +458,72 @@ System::String * CrossNetRuntime::BaseTypeWrapper<System::Char>::ToString()
 
 System::String * CrossNetRuntime::BaseTypeWrapper<System::Int16>::ToString()
 {
-    System::Char  text[16];
-    _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%d", mValue);
-    return (System::String::__Create__(text));
+    return (CrossNetRuntime::Number::ToString((System::Int32)mValue));
 }
 
-System::String * CrossNetRuntime::BaseTypeWrapper<System::Int16>::ToString(System::String * /* format */)
+System::String * CrossNetRuntime::BaseTypeWrapper<System::Int16>::ToString(System::String * format)
 {
-    System::Char  text[16];
-    _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%d", mValue);
-    return (System::String::__Create__(text));
+    return (CrossNetRuntime::Number::ToString((System::Int64)mValue, format, 16));
 }
 
 System::String * CrossNetRuntime::BaseTypeWrapper<System::UInt16>::ToString()
 {
-    System::Char  text[16];
-    _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%u", mValue);
-    return (System::String::__Create__(text));
+    return (CrossNetRuntime::Number::ToString((System::UInt32)mValue));
 }
 
-System::String * CrossNetRuntime::BaseTypeWrapper<System::UInt16>::ToString(System::String * /* format */)
+System::String * CrossNetRuntime::BaseTypeWrapper<System::UInt16>::ToString(System::String * format)
 {
-    System::Char  text[16];
-    _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%d", mValue);
-    return (System::String::__Create__(text));
+    return (CrossNetRuntime::Number::ToString((System::UInt64)mValue, format));
 }
 
 template <>
 System::String * CrossNetRuntime::CommonBaseTypeWrapper<System::Int32>::ToString()
 {
-    System::Char  text[16];
-    _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%d", mValue);
-    return (System::String::__Create__(text));
+    return (CrossNetRuntime::Number::ToString(mValue));
 }
 
 System::String * CrossNetRuntime::BaseTypeWrapper<System::UInt32>::ToString()
 {
-    System::Char  text[16];
-    _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%d", mValue);
-    return (System::String::__Create__(text));
+    return (CrossNetRuntime::Number::ToString(mValue));
 }
 
-System::String * CrossNetRuntime::BaseTypeWrapper<System::UInt32>::ToString(System::String * /* format */)
+System::String * CrossNetRuntime::BaseTypeWrapper<System::UInt32>::ToString(System::String * format)
 {
-    System::Char  text[16];
-    _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%d", mValue);
-    return (System::String::__Create__(text));
+    return (CrossNetRuntime::Number::ToString((System::UInt64)mValue, format));
 }
 
 System::String * CrossNetRuntime::BaseTypeWrapper<System::Int64>::ToString()
 {
-    System::Char  text[32];
-    _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%ld", mValue);
-    return (System::String::__Create__(text));
+    return (CrossNetRuntime::Number::ToString(mValue));
 }
 
 System::String * CrossNetRuntime::BaseTypeWrapper<System::UInt64>::ToString()
 {
-    System::Char  text[32];
-    _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%lu", mValue);
-    return (System::String::__Create__(text));
+    return (CrossNetRuntime::Number::ToString(mValue));
 }
 
-System::String * CrossNetRuntime::BaseTypeWrapper<System::Int64>::ToString(System::String * /*format*/)
+System::String * CrossNetRuntime::BaseTypeWrapper<System::Int64>::ToString(System::String * format)
 {
-    System::Char  text[32];
-    _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%ld", mValue);
-    return (System::String::__Create__(text));
+    return (CrossNetRuntime::Number::ToString(mValue, format, 64));
 }
 
-System::String * CrossNetRuntime::BaseTypeWrapper<System::UInt64>::ToString(System::String * /*format*/)
+System::String * CrossNetRuntime::BaseTypeWrapper<System::UInt64>::ToString(System::String * format)
 {
-    System::Char  text[32];
-    _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%lu", mValue);
-    return (System::String::__Create__(text));
+    return (CrossNetRuntime::Number::ToString(mValue, format));
 }
 
 System::String * CrossNetRuntime::BaseTypeWrapper<System::Single>::ToString()
 {
-    System::Char  text[16];
-    _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%f", mValue);
-    return (System::String::__Create__(text));
+    return (CrossNetRuntime::Number::ToString(mValue));
 }
 
 System::String * CrossNetRuntime::BaseTypeWrapper<System::Double>::ToString()
 {
-    System::Char  text[16];
-    _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%f", mValue);
-    return (System::String::__Create__(text));
+    return (CrossNetRuntime::Number::ToString(mValue));
 }
 
 System::String * CrossNetRuntime::BaseTypeWrapper<System::Decimal>::ToString()
 {
-    System::Char  text[16];
-    _snwprintf_s(text, CN_ARRAY_SIZE(text), CN_ARRAY_SIZE(text), L"%f", mValue);
-    return (System::String::__Create__(text));
+    // The decimals are stored as doubles
+    return (CrossNetRuntime::Number::ToString((System::Double)mValue));
 }
\ No newline at end of file
@@ -362,6 +362,19 @@ void    GCAllocator::InternalFree(AllocStructure * freedPtr, int alignedSize)
 
 #endif
 
+void    GCAllocator::Shrink(void * ptr, int size, int newSize)
+{
+    CROSSNET_ASSERT(IsAligned(ptr), "");
+    CROSSNET_ASSERT(newSize <= size, "");
+
+    int alignedSize = Align(size);
+    int newAlignedSize = Align(newSize);
+    if (newAlignedSize < alignedSize)
+    {
+        Free((unsigned char *)ptr + newAlignedSize, alignedSize - newAlignedSize);
+    }
+}
+
 void * GCAllocator::GetCurrentAllocPointer()
 {
     return (sCurrentAllocPointer);
@@ -17,6 +17,8 @@
 #include "CrossNetRuntime/GC/GCAllocator.h"
 #include "CrossNetRuntime/CrossNetRuntime.h"
 #include <time.h>
+// For _mm_prefetch
+#include <xmmintrin.h>
 
 namespace CrossNetRuntime
 {
@@ -33,6 +35,7 @@ double          GCManager::sNumSecondsInTracingStack = 0.0f;
 double          GCManager::sNumSecondsInTracingStatics = 0.0f;
 double          GCManager::sNumSecondsInCollect = 0.0f;
 void *          GCManager::sTopOfStack = NULL;
+GCManager::TraceHook *  GCManager::sTraceHooks = NULL;
 
 void GCManager::Setup(const InitOptions & /*options*/)
 {
@@ -85,6 +88,10 @@ void GCManager::Collect(int /* generation */, bool final)
 
         clock_t startTracingPermanent = clock();
         CrossNetRuntime::Trace((unsigned char)currentMarker);
+        for (TraceHook * hook = sTraceHooks ; hook != NULL ; hook = hook->mNext)
+        {
+            hook->mTrace((unsigned char)currentMarker);
+        }
         clock_t endTracingPermanent = clock();
         diff = (double)(endTracingPermanent - startTracingPermanent) / (double)CLOCKS_PER_SEC;
         sNumSecondsInTracingPermanent += diff;
@@ -247,6 +254,35 @@ void GCManager::CheckCollecting(::System::Object * /*object*/)
     CROSSNET_ASSERT(sCollecting, "");
 }
 
+void GCManager::TraceReferences(void * instance, const ReferenceOffset * referenceOffsets, unsigned char currentMark)
+{
+    unsigned char * base = static_cast<unsigned char *>(instance);
+    const ReferenceOffset * offset;
+
+    // Each reference will read the mark of the child, start loading them right now
+    for (offset = referenceOffsets ; *offset != END_OF_REFERENCE_OFFSETS ; ++offset)
+    {
+        const char * child = *reinterpret_cast<const char * *>(base + *offset);
+        if (child != NULL)
+        {
+            _mm_prefetch(child, _MM_HINT_T0);
+        }
+    }
+
+    for (offset = referenceOffsets ; *offset != END_OF_REFERENCE_OFFSETS ; ++offset)
+    {
+        Trace(*reinterpret_cast<::System::Object * *>(base + *offset), currentMark);
+    }
+}
+
+void GCManager::RegisterTraceHook(TraceHook * hook)
+{
+    CROSSNET_ASSERT(hook->mTrace != NULL, "");
+    CROSSNET_ASSERT(sCollecting == false, "Can't register a hook during a collection!");
+    hook->mNext = sTraceHooks;
+    sTraceHooks = hook;
+}
+
 int GCManager::GetNumCollections()
 {
     return (sNumCollections);
@@ -19,13 +19,19 @@
 #include "CrossNetRuntime/GC/GCManager.h"
 #include "CrossNetRuntime/Internal/BaseTypes.h"
 #include <memory.h>
+#include <algorithm>
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
 
 namespace CrossNetRuntime
 {
 
-void * *    InterfaceMapper::sInterfaceMap = NULL;
-int         InterfaceMapper::sInterfaceMapSize = 0;
-void * *    InterfaceMapper::sNextFreeSlot= NULL;
+const ReferenceOffset NO_REFERENCE_OFFSETS[] = { END_OF_REFERENCE_OFFSETS };
+
+std::vector<InterfaceMapper::Segment *> InterfaceMapper::sSegments;
+int         InterfaceMapper::sSegmentSize = 0;
 
 // System.Object ID is 0
 // System.ValueType ID is -1
@@ -34,25 +40,30 @@ void * *    InterfaceMapper::sNextFreeSlot= NULL;
 int         InterfaceMapper::sNextInterfaceId = 1;
 // Objects start with -2, and are strictly negative
 int         InterfaceMapper::sNextObjectId = -2;
-void *      InterfaceMapper::sLastInterfaceMap = NULL;
 
+// Both lists are kept sorted so the dynamic ids can skip the static ids with a binary search
 std::vector<int> InterfaceMapper::sStaticInterfaceId;
 std::vector<int> InterfaceMapper::sStaticObjectId;
 
 std::vector<::System::Type *> InterfaceMapper::sAllTypes;
 
+// Kept out of the header so windows.h is not needed by the rest of the runtime
+static CRITICAL_SECTION sRegistrationLock;
+
 void InterfaceMapper::Setup(const ::CrossNetRuntime::InitOptions & options)
 {
     // Instead we might want to allocate by smaller size and maybe several times...
     // One thing to worry about is if the IID grows very big...
 
+    // Before anything is registered, the callback below might already use some generic types
+    ::InitializeCriticalSection(&sRegistrationLock);
+
     int interfaceMapSize = options.mInterfaceMapSize;
     CROSSNET_ASSERT((interfaceMapSize & sizeof(void *)) == 0, "");
     interfaceMapSize &= -(int)(sizeof(void *));             // Make sure the size is aligned on 4 bytes
-    sInterfaceMap = (void * *)(options.mInterfaceMapBuffer);
-    __memclear__(sInterfaceMap, interfaceMapSize);
-    sInterfaceMapSize = interfaceMapSize / sizeof(void *);
-    sNextFreeSlot = sInterfaceMap;
+    sSegmentSize = interfaceMapSize / sizeof(void *);
+    // The first segment uses the buffer provided by the user, the next ones (if any) will have the same size
+    sSegments.push_back(CreateSegment(options.mInterfaceMapBuffer, sSegmentSize, false));
     sAllTypes.reserve(options.mInitialReservedNumTypes);
 
     options.mRegisterSystemTypeCallback();
@@ -60,8 +71,36 @@ void InterfaceMapper::Setup(const ::CrossNetRuntime::InitOptions & options)
 
 void InterfaceMapper::Teardown()
 {
-    sInterfaceMap = NULL;
+    const InitOptions & options = GetOptions();
+    std::vector<Segment *>::iterator it, itEnd;
+    it = sSegments.begin();
+    itEnd = sSegments.end();
+    while (it != itEnd)
+    {
+        Segment * segment = *it;
+        if (segment->mOwnBuffer)
+        {
+            options.mUnmanagedFreeCallback(segment->mBuffer);
+        }
+        options.mUnmanagedFreeCallback(segment->mSlotOwners);
+        options.mUnmanagedFreeCallback(segment->mUsedSlots);
+        options.mUnmanagedFreeCallback(segment);
+        ++it;
+    }
+    sSegments.clear();
     sAllTypes.clear();
+
+    ::DeleteCriticalSection(&sRegistrationLock);
+}
+
+void InterfaceMapper::Lock()
+{
+    ::EnterCriticalSection(&sRegistrationLock);
+}
+
+void InterfaceMapper::Unlock()
+{
+    ::LeaveCriticalSection(&sRegistrationLock);
 }
 
 void InterfaceMapper::Trace(unsigned char currentMark)
@@ -81,14 +120,13 @@ void InterfaceMapper::Trace(unsigned char currentMark)
 void * * InterfaceMapper::RegisterInterfaceStaticId(int staticId, InterfaceInfo * info, int numInterfaceInfos)
 {
     CROSSNET_ASSERT(staticId > 0, "The interface ID should be strictly positive!");
-    // Make sure the static Id is unique
-    std::vector<int>::iterator itBegin = sStaticInterfaceId.begin();
-    std::vector<int>::iterator itEnd = sStaticInterfaceId.end();
-    for (std::vector<int>::iterator it = itBegin ; it != itEnd ; ++it)
-    {
-        CROSSNET_ASSERT(*it != staticId, "The static Id has been already registered!");
-    }
-    sStaticInterfaceId.push_back(staticId);
+    // The ids below sNextInterfaceId might have been given to a dynamic interface already
+    //  Checked in release too, the two types would share the wrapper slots and the casts
+    CROSSNET_CHECK(staticId >= sNextInterfaceId, "The static Id collides with a dynamic Id!");
+    // Make sure the static Id is unique (two assemblies parsed separately with the same FirstStaticId)
+    std::vector<int>::iterator it = std::lower_bound(sStaticInterfaceId.begin(), sStaticInterfaceId.end(), staticId);
+    CROSSNET_CHECK((it == sStaticInterfaceId.end()) || (*it != staticId), "The static Id has been already registered!");
+    sStaticInterfaceId.insert(it, staticId);
 
     // We added the static Id, and updated the dynamic Id accordingly...
     System::Type * type = CreateSystemType();
@@ -99,14 +137,13 @@ void * * InterfaceMapper::RegisterInterfaceStaticId(int staticId, InterfaceInfo
 void * * InterfaceMapper::RegisterObjectStaticId(int staticId, size_t size, InterfaceInfo * info, int numInterfaceInfos, void * * parentInterfaceMap)
 {
     CROSSNET_ASSERT(staticId <= 0, "The object ID should be negative!");
-    // Make sure the static Id is unique
-    std::vector<int>::iterator itBegin = sStaticObjectId.begin();
-    std::vector<int>::iterator itEnd = sStaticObjectId.end();
-    for (std::vector<int>::iterator it = itBegin ; it != itEnd ; ++it)
-    {
-        CROSSNET_ASSERT(*it != staticId, "The static Id has been already registered!");
-    }
-    sStaticObjectId.push_back(staticId);
+    // The ids between -2 and sNextObjectId might have been given to a dynamic object already
+    //  Checked in release too, the two types would be the same class for the casts
+    CROSSNET_CHECK((staticId > -2) || (staticId <= sNextObjectId), "The static Id collides with a dynamic Id!");
+    // Make sure the static Id is unique (two assemblies parsed separately with the same FirstStaticId)
+    std::vector<int>::iterator it = std::lower_bound(sStaticObjectId.begin(), sStaticObjectId.end(), staticId);
+    CROSSNET_CHECK((it == sStaticObjectId.end()) || (*it != staticId), "The static Id has been already registered!");
+    sStaticObjectId.insert(it, staticId);
 
     // We added the static Id, and updated the dynamic Id accordingly...
     System::Type * type = CreateSystemType();
@@ -138,61 +175,18 @@ void * * InterfaceMapper::CreateInterfaceMap(System::Type * type, int id, size_t
         CROSSNET_ASSERT(info == NULL, "");
         CROSSNET_ASSERT(numInterfaceInfos == 0, "");
         CROSSNET_ASSERT(parentInterfaceMap == NULL, "");
-        void * * interfaceMap = FindNextFreeSlots(MINIMUM_BASE_SLOT_SIZE);
-        interfaceMap += (MINIMUM_BASE_SLOT_SIZE - OFFSET_FROM_END_OF_BASE_SLOT);
-        interfaceMap[CURRENT_ID] = (void *)(id);
-        interfaceMap[SIZE] = (void *)size;
-        interfaceMap[NUMBER_OF_INTERFACES_AND_CLASSES] = (void *)(USED_SLOT);   // No classes, no interfaces, but still used
-        interfaceMap[TYPEOF] = type;
-
-        sNextFreeSlot = interfaceMap + 1;   // This is a special case...
-                                            // This Id is zero, but we don't want this value to be picked up by the free slot
-        UpdateFreeSlot();
-
-        if (interfaceMap > sLastInterfaceMap)
-        {
-            sLastInterfaceMap = interfaceMap;
-        }
-        return (interfaceMap);
     }
 
     if (info == NULL)
     {
         CROSSNET_ASSERT(numInterfaceInfos == 0, "");
-
-        if (parentInterfaceMap == NULL)
-        {
-            // Simplest case, no base interfaces, no parent implementation
-            void * * interfaceMap = FindNextFreeSlots(MINIMUM_BASE_SLOT_SIZE);
-            interfaceMap += (MINIMUM_BASE_SLOT_SIZE - OFFSET_FROM_END_OF_BASE_SLOT);
-            interfaceMap[CURRENT_ID] = (void *)(id);
-            interfaceMap[SIZE] = (void *)size;
-            interfaceMap[NUMBER_OF_INTERFACES_AND_CLASSES] = (void *)(USED_SLOT);   // No classes, no interfaces
-            interfaceMap[TYPEOF] = type;
-            UpdateFreeSlot();
-
-            if (interfaceMap > sLastInterfaceMap)
-            {
-                sLastInterfaceMap = interfaceMap;
-            }
-            return (interfaceMap);
-        }
-
-        // Otherwise just handle the standard default case...
     }
     else
     {
         CROSSNET_ASSERT(numInterfaceInfos != 0, "");
     }
 
-    // There are several solutions but we do a simple brut force
-    // It seems that if we were using bit mask we would be faster though... ;)
-
-    // The current search is linear, in order to avoid wasting space...
-    // We could speed up things a little bit if we were searching in random places
-    // But it would waste more memory...
-
-    int numBackFill = MINIMUM_BASE_SLOT_SIZE;   // Room for the ID and the number of interfaces and classes
+    int numBackFill = MINIMUM_BASE_SLOT_SIZE;   // Room for the ID, the size, the number of interfaces and classes, the type, the segment and the reference offsets
     int numBaseClasses = 0;
     int * baseClasses = NULL;
     int baseClassId = 0;
@@ -214,48 +208,30 @@ void * * InterfaceMapper::CreateInterfaceMap(System::Type * type, int id, size_t
     }
     numBackFill += numInterfaceInfos;
 
-    void * * current = FindNextFreeSlots(numBackFill);
-
-    for ( ; ; )
+    // New interface maps are always added to the last segment, the previous ones are considered full
+    Segment * segment = sSegments.back();
+    int start = FindFreeSlots(segment, numBackFill, info, numInterfaceInfos);
+    if (start < 0)
     {
-        int i;
-        for (i = 0 ; i < numInterfaceInfos ; ++i)
+        // Not enough room (or the interface ids are too big for the segment), continue in a new segment
+        segment = Grow(numBackFill, info, numInterfaceInfos);
+        start = FindFreeSlots(segment, numBackFill, info, numInterfaceInfos);
+        if (start < 0)
         {
-            int interfaceId = info[i].mInterfaceId;
-            // Offset the index to match the correct position
-            interfaceId += (numBackFill - OFFSET_FROM_END_OF_BASE_SLOT);
-            if (((current - sInterfaceMap) + interfaceId) >= sInterfaceMapSize)
-            {
-                CROSSNET_FAIL("InterfaceMap is not big enough!");
-                return (NULL);
-            }
-
-            if (current[interfaceId] != NULL)
-            {
-                // This slot in the interface map is already full, this combination doesn't work
-                break;
-            }
-
-            // This slot is empty, let's try the remaining interfaces to see if they fit
-        }
-
-        if (i == numInterfaceInfos)
-        {
-            // Enough room for all the interface wrappers!
-            break;
+            CROSSNET_FAIL("InterfaceMap is not big enough!");
+            return (NULL);
         }
-
-        // We could not map all the interfaces, let's go further then...
-        // Skip one and look at the next free block of the size numBackFill slots
-        current = FindNextFreeSlots(current + 1, numBackFill);
     }
 
     // Found the block we were interested in...
-    current += (numBackFill - OFFSET_FROM_END_OF_BASE_SLOT);
+    int index = start + numBackFill - OFFSET_FROM_END_OF_BASE_SLOT;
+    void * * current = segment->mBuffer + index;
 
     current[CURRENT_ID] = (void *)id;
     current[SIZE] = (void *)size;
     current[TYPEOF] = type;
+    current[SEGMENT] = segment;
+    current[REFERENCE_OFFSETS] = NULL;
     WriteNumInterfacesAndClasses(current, numInterfaceInfos, numBaseClasses);
 
     // Now let's write all the interface list and the object list
@@ -277,130 +253,216 @@ void * * InterfaceMapper::CreateInterfaceMap(System::Type * type, int id, size_t
         }
     }
 
+    // Every slot of the header and the lists is used now (even if the value stored is 0)
+    for (int i = 0 ; i < numBackFill ; ++i)
+    {
+        UseSlot(segment, start + i);
+    }
+
     // Finally let's write the interface wrappers
     for (int i = 0 ; i < numInterfaceInfos ; ++i)
     {
+        IInterface * wrapper = info[i].mInterfaceWrapper;
+        if (wrapper == NULL)
+        {
+            // Without wrapper the slot stays free, so it can't be owned
+            continue;
+        }
         int iid = info[i].mInterfaceId;
-        CROSSNET_ASSERT(((current - sInterfaceMap) + iid) < sInterfaceMapSize, "Should not overflow here, as we tested earlier!");
-        CROSSNET_ASSERT(current[iid] == NULL, "Should be empty as we tested earlier!");
-        current[iid] = info[i].mInterfaceWrapper;
+        CROSSNET_ASSERT(index + iid < segment->mSize, "Should not overflow here, as we tested earlier!");
+        CROSSNET_ASSERT(IsSlotUsed(segment, index + iid) == false, "Should be empty as we tested earlier!");
+        current[iid] = wrapper;
+        segment->mSlotOwners[index + iid] = current;
+        UseSlot(segment, index + iid);
     }
 
-    // Update the free slot if needed
-    UpdateFreeSlot();
+    UpdateFirstFree(segment);
 
-    if (current > sLastInterfaceMap)
+    if (current > segment->mLastInterfaceMap)
     {
-        sLastInterfaceMap = current;
+        segment->mLastInterfaceMap = current;
     }
 
     // We are done here
     return (current);
 }
 
-void InterfaceMapper::UpdateFreeSlot()
+InterfaceMapper::Segment * InterfaceMapper::CreateSegment(void * buffer, int numSlots, bool ownBuffer)
 {
-    if (*sNextFreeSlot == NULL)
+    const InitOptions & options = GetOptions();
+
+    // The bitmap only has complete words
+    if (buffer == NULL)
     {
-        return;
+        numSlots = (numSlots + BITS_PER_WORD - 1) & ~(BITS_PER_WORD - 1);
+        buffer = options.mUnmanagedAllocateCallback(numSlots * sizeof(void *));
     }
-    bool foundFree = false;
-    void * * nextFree = sNextFreeSlot;
-    while ((nextFree - sInterfaceMap) < sInterfaceMapSize)
+    else
     {
-        if (*nextFree == NULL)
-        {
-            // Found the next free slot
-            foundFree = true;
-            break;
-        }
-        ++nextFree;
+        // We can't use more than the buffer provided by the user, round down instead
+        numSlots &= ~(BITS_PER_WORD - 1);
     }
-    if (foundFree == false)
+
+    Segment * segment = static_cast<Segment *>(options.mUnmanagedAllocateCallback(sizeof(Segment)));
+    segment->mBuffer = static_cast<void * *>(buffer);
+    segment->mSize = numSlots;
+    segment->mFirstFree = 0;
+    segment->mLastInterfaceMap = NULL;
+    segment->mOwnBuffer = ownBuffer;
+    segment->mSlotOwners = static_cast<void * * *>(options.mUnmanagedAllocateCallback(numSlots * sizeof(void * *)));
+    segment->mUsedSlots = static_cast<unsigned int *>(options.mUnmanagedAllocateCallback(numSlots / BITS_PER_WORD * sizeof(unsigned int)));
+
+    __memclear__(segment->mBuffer, numSlots * sizeof(void *));
+    __memclear__(segment->mSlotOwners, numSlots * sizeof(void * *));
+    __memclear__(segment->mUsedSlots, numSlots / BITS_PER_WORD * sizeof(unsigned int));
+    return (segment);
+}
+
+InterfaceMapper::Segment * InterfaceMapper::Grow(int numberOfSlots, InterfaceInfo * info, int numInterfaceInfos)
+{
+    // The new segment must be able to contain at least the interface map that didn't fit
+    int numSlots = numberOfSlots;
+    for (int i = 0 ; i < numInterfaceInfos ; ++i)
     {
-        // No more free slot in the interface table! It's completey packed with no fragmentation!
-        // Next time, we won't be able to add an interface!
-        CROSSNET_FAIL("InterfaceMap is full!");
-        sNextFreeSlot = NULL;      // It will force the crash next time...
+        int slot = numberOfSlots + info[i].mInterfaceId;
+        if (slot > numSlots)
+        {
+            numSlots = slot;
+        }
     }
-    else
+    // Add some room for the following types
+    numSlots *= 2;
+    if (numSlots < sSegmentSize)
     {
-        sNextFreeSlot = nextFree;
+        numSlots = sSegmentSize;
     }
-}
 
-void * * InterfaceMapper::FindNextFreeSlots(int numberOfSlots)
-{
-    return (FindNextFreeSlots(sNextFreeSlot, numberOfSlots));
+    Segment * segment = CreateSegment(NULL, numSlots, true);
+    sSegments.push_back(segment);
+    return (segment);
 }
 
-void * * InterfaceMapper::FindNextFreeSlots(void * * currentSlot, int numberOfSlots)
+int InterfaceMapper::FindFreeSlots(const Segment * segment, int numberOfSlots, InterfaceInfo * info, int numInterfaceInfos)
 {
-    // Careful, this code doesn;t check if the 
+    // We look for numberOfSlots consecutive free slots (header and lists)
+    // where the slot of each interface wrapper (counted from the end of the header) is free as well
+    int start = segment->mFirstFree;
     for ( ; ; )
     {
-        void * * localSlot = currentSlot;
-        bool collision = false;
-        for (int i = 0 ; i < numberOfSlots ; ++i)
+        start = FindFreeRun(segment, start, numberOfSlots);
+        if (start < 0)
+        {
+            return (-1);
+        }
+
+        int index = start + numberOfSlots - OFFSET_FROM_END_OF_BASE_SLOT;
+        int i;
+        for (i = 0 ; i < numInterfaceInfos ; ++i)
         {
-            CROSSNET_ASSERT(localSlot < (sInterfaceMap + sInterfaceMapSize), "");
-            if (localSlot[i] != NULL)
+            if (info[i].mInterfaceWrapper == NULL)
             {
-                // There is a collision, instead of restarting at currentSlot + 1
-                // We restart just after the collision...
-                currentSlot += i + 1;
-                collision = true;
+                // No wrapper to store
+                continue;
+            }
+            int slot = index + info[i].mInterfaceId;
+            if (slot >= segment->mSize)
+            {
+                // Any further position will overflow as well
+                return (-1);
+            }
+            if (IsSlotUsed(segment, slot))
+            {
+                // This slot in the interface map is already full, this combination doesn't work
                 break;
             }
         }
 
-        if (collision == false)
+        if (i == numInterfaceInfos)
         {
-            return (currentSlot);
+            // Enough room for all the interface wrappers!
+            return (start);
         }
+
+        // We could not map all the interfaces, let's go further then...
+        ++start;
     }
 }
 
-int InterfaceMapper::RetrieveNextInterfaceId()
+int InterfaceMapper::FindFreeRun(const Segment * segment, int start, int numberOfSlots)
 {
-    int nextInterfaceId = sNextInterfaceId;
-
-    // This loop has two purposes, first we find the next available id by comparing with the static ids
-    // And we clean the list of static ids to optimize the search...
-    for (;;)
+    // Look at the bitmap word by word when possible, most words are either full or empty
+    int runLength = 0;
+    int slot = start;
+    while (slot < segment->mSize)
     {
-        bool collision = false;
-        std::vector<int>::iterator itBegin = sStaticInterfaceId.begin();
-        std::vector<int>::iterator itEnd = sStaticInterfaceId.end();
-        std::vector<int>::iterator toDelete = itEnd;
-        for (std::vector<int>::iterator it = itBegin ; it != itEnd ; ++it)
+        if ((slot % BITS_PER_WORD) == 0)
         {
-            if (*it < nextInterfaceId)
+            unsigned int word = segment->mUsedSlots[slot / BITS_PER_WORD];
+            if (word == 0xffffffff)
             {
-                toDelete = it;
-                break;
+                // 32 used slots, the run is broken
+                runLength = 0;
+                slot += BITS_PER_WORD;
+                continue;
             }
-            if (*it == nextInterfaceId)
+            if (word == 0)
             {
-                collision = true;
+                // 32 free slots
+                runLength += BITS_PER_WORD;
+                slot += BITS_PER_WORD;
+                if (runLength >= numberOfSlots)
+                {
+                    return (slot - runLength);
+                }
+                continue;
             }
         }
 
-        if (toDelete != itEnd)
+        if (IsSlotUsed(segment, slot))
         {
-            // There is one id to delete, erase it
-            sStaticInterfaceId.erase(toDelete);
-            // And continue the loop without looking at collision
-            // as we want to erase all the obsolete static id
-            // I believe there is a better to do this with STL but I don't have the time to look at it
-            continue;
+            runLength = 0;
         }
-        if (collision == false)
+        else
         {
-            // Found one without collision, we are done...
-            break;
+            ++runLength;
+            if (runLength == numberOfSlots)
+            {
+                return (slot - numberOfSlots + 1);
+            }
         }
-        // Some collision, let's go forward a bit...
+        ++slot;
+    }
+    return (-1);
+}
+
+void InterfaceMapper::UseSlot(Segment * segment, int slot)
+{
+    segment->mUsedSlots[slot / BITS_PER_WORD] |= (1u << (slot % BITS_PER_WORD));
+}
+
+void InterfaceMapper::UpdateFirstFree(Segment * segment)
+{
+    int slot = segment->mFirstFree;
+    // Skip the full words first
+    while ((slot < segment->mSize) && (segment->mUsedSlots[slot / BITS_PER_WORD] == 0xffffffff))
+    {
+        slot = (slot + BITS_PER_WORD) & ~(BITS_PER_WORD - 1);
+    }
+    while ((slot < segment->mSize) && IsSlotUsed(segment, slot))
+    {
+        ++slot;
+    }
+    segment->mFirstFree = slot;
+}
+
+int InterfaceMapper::RetrieveNextInterfaceId()
+{
+    int nextInterfaceId = sNextInterfaceId;
+
+    // Skip the ids reserved by the static interfaces
+    // The static ids generated by the parser are contiguous, so this is mostly one binary search
+    while (std::binary_search(sStaticInterfaceId.begin(), sStaticInterfaceId.end(), nextInterfaceId))
+    {
         ++nextInterfaceId;
     }
     sNextInterfaceId = nextInterfaceId + 1;
@@ -411,62 +473,44 @@ int InterfaceMapper::RetrieveNextObjectId()
 {
     int nextObjectId = sNextObjectId;
 
-    // This loop has two purposes, first we find the next available id by comparing with the static ids
-    // And we clean the list of static ids to optimize the search...
-    for (;;)
+    // Same thing for the objects, except that we go backward
+    while (std::binary_search(sStaticObjectId.begin(), sStaticObjectId.end(), nextObjectId))
     {
-        bool collision = false;
-        std::vector<int>::iterator itBegin = sStaticObjectId.begin();
-        std::vector<int>::iterator itEnd = sStaticObjectId.end();
-        std::vector<int>::iterator toDelete = itEnd;
-        for (std::vector<int>::iterator it = itBegin ; it != itEnd ; ++it)
-        {
-            if (*it > nextObjectId)
-            {
-                toDelete = it;
-                break;
-            }
-            if (*it == nextObjectId)
-            {
-                collision = true;
-            }
-        }
-
-        if (toDelete != itEnd)
-        {
-            // There is one id to delete, erase it
-            sStaticObjectId.erase(toDelete);
-            // And continue the loop without looking at collision
-            // as we want to erase all the obsolete static id
-            // I believe there is a better to do this with STL but I don't have the time to look at it
-            continue;
-        }
-        if (collision == false)
-        {
-            // Found one without collision, we are done...
-            break;
-        }
-        // Some collision, let's go backward a bit...
         --nextObjectId;
     }
     sNextObjectId = nextObjectId - 1;
     return (nextObjectId);
 }
 
-bool InterfaceMapper::InInterfaceMapSpace(void * pointer)
+void InterfaceMapper::SetReferenceOffsets(void * * interfaceMap, const ReferenceOffset * referenceOffsets)
 {
-    if (pointer < sInterfaceMap)
+    CROSSNET_ASSERT(interfaceMap != NULL, "");
+    // The offsets are generated with offsetof(), so they are pointer aligned
+    // (NULL is valid, the GC calls __Trace__() then)
+    for (const ReferenceOffset * offset = referenceOffsets ; (offset != NULL) && (*offset != END_OF_REFERENCE_OFFSETS) ; ++offset)
     {
-        // The pointer points before the start of the interface map buffer
-        // It cannot be an interface map
-        return (false);
+        CROSSNET_ASSERT((*offset >= 0) && (*offset + sizeof(void *) <= GetSize(interfaceMap)), "The reference is outside the instance!");
+        CROSSNET_ASSERT((*offset % sizeof(void *)) == 0, "The reference is not aligned!");
     }
-    if (pointer > sLastInterfaceMap)
+    interfaceMap[REFERENCE_OFFSETS] = const_cast<ReferenceOffset *>(referenceOffsets);
+}
+
+bool InterfaceMapper::InInterfaceMapSpace(void * pointer)
+{
+    std::vector<Segment *>::const_iterator it, itEnd;
+    it = sSegments.begin();
+    itEnd = sSegments.end();
+    while (it != itEnd)
     {
-        // If that's after the last interface map, it is not in the space
-        return (false);
+        const Segment * segment = *it;
+        // Between the start of the buffer and the last interface map of the segment
+        if ((pointer >= segment->mBuffer) && (pointer <= segment->mLastInterfaceMap))
+        {
+            return (true);
+        }
+        ++it;
     }
-    return (true);
+    return (false);
 }
 
 }
@@ -15,6 +15,7 @@
 
 #include "CrossNetRuntime/StringPooler.h"
 #include "CrossNetRuntime/GC/GCManager.h"
+#include "CrossNetRuntime/Internal/Chars.h"
 #include "CrossNetRuntime/System/String.h"
 
 namespace CrossNetRuntime
@@ -22,9 +23,9 @@ namespace CrossNetRuntime
 
 StringPooler::StringHashMap   StringPooler::sAllStrings;
 
-::System::String * StringPooler::GetOrCreateString(System::Char * text)
+::System::String * StringPooler::GetOrCreateString(const System::Char * text)
 {
-    System::Int32 length = (System::Int32)wcslen(text);
+    System::Int32 length = CrossNetRuntime::GetCharLength(text);
     Key k(text, length);
     StringHashMap::const_iterator it = sAllStrings.find(k);
     if (it != sAllStrings.end())
@@ -39,7 +40,7 @@ StringPooler::StringHashMap   StringPooler::sAllStrings;
     return (str);
 }
 
-::System::String * StringPooler::GetOrCreateString(System::Char * text, System::Int32 length)
+::System::String * StringPooler::GetOrCreateString(const System::Char * text, System::Int32 length)
 {
     Key k(text, length);
     StringHashMap::const_iterator it = sAllStrings.find(k);
@@ -0,0 +1,571 @@
+/*
+    CrossNet - Copyright (c) 2007 Olivier Nallet
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+    OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "CrossNetRuntime/StringSearch.h"
+#include "CrossNetRuntime/Assert.h"
+
+#if CROSSNET_STRING_SSE2
+// For __cpuid, _BitScanForward and _BitScanReverse
+#include <intrin.h>
+// For the SSE2 intrinsics
+#include <emmintrin.h>
+#endif
+
+namespace CrossNetRuntime
+{
+
+CharSet::CharSet(const ::System::Char * chars, ::System::Int32 length)
+    :
+    mChars(chars),
+    mLength(length),
+    mAllInBitmap(true)
+{
+    __memclear__(mBitmap, sizeof(mBitmap));
+    for (int i = 0 ; i < length ; ++i)
+    {
+        unsigned int value = (unsigned int)chars[i];
+        if (value < 256)
+        {
+            mBitmap[value >> 5] |= (1u << (value & 31));
+        }
+        else
+        {
+            mAllInBitmap = false;
+        }
+    }
+}
+
+// Scalar versions, used when SSE2 is not available and for the few characters after the last full SSE2 block
+
+static const ::System::Char * FindCharScalar(const ::System::Char * start, const ::System::Char * end, ::System::Char c)
+{
+    while (start < end)
+    {
+        if (*start == c)
+        {
+            return (start);
+        }
+        ++start;
+    }
+    return (NULL);
+}
+
+static const ::System::Char * FindLastCharScalar(const ::System::Char * start, const ::System::Char * end, ::System::Char c)
+{
+    while (start < end)
+    {
+        --end;
+        if (*end == c)
+        {
+            return (end);
+        }
+    }
+    return (NULL);
+}
+
+static const ::System::Char * FindAnyCharScalar(const ::System::Char * start, const ::System::Char * end, const CharSet & set)
+{
+    while (start < end)
+    {
+        if (set.Contains(*start))
+        {
+            return (start);
+        }
+        ++start;
+    }
+    return (NULL);
+}
+
+static const ::System::Char * FindLastAnyCharScalar(const ::System::Char * start, const ::System::Char * end, const CharSet & set)
+{
+    while (start < end)
+    {
+        --end;
+        if (set.Contains(*end))
+        {
+            return (end);
+        }
+    }
+    return (NULL);
+}
+
+static const ::System::Char * SkipWhiteSpacesScalar(const ::System::Char * start, const ::System::Char * end)
+{
+    while ((start < end) && StringSearch::IsWhiteSpace(*start))
+    {
+        ++start;
+    }
+    return (start);
+}
+
+static ::System::Int32 FindMismatchScalar(const ::System::Char * a, const ::System::Char * b, ::System::Int32 length)
+{
+    for (::System::Int32 i = 0 ; i < length ; ++i)
+    {
+        if (a[i] != b[i])
+        {
+            return (i);
+        }
+    }
+    return (length);
+}
+
+CROSSNET_FINLINE
+static bool MatchesAt(const ::System::Char * position, const ::System::Char * needle, ::System::Int32 length)
+{
+    return (__memcmp__(position, needle, length * sizeof(::System::Char)) == 0);
+}
+
+static const ::System::Char * FindShortStringScalar(const ::System::Char * start, const ::System::Char * end, const ::System::Char * needle, ::System::Int32 needleLength)
+{
+    CROSSNET_ASSERT(needleLength >= 2, "");
+    const ::System::Char * lastPosition = end - needleLength;
+    ::System::Char first = needle[0];
+    while (start <= lastPosition)
+    {
+        if ((*start == first) && MatchesAt(start + 1, needle + 1, needleLength - 1))
+        {
+            return (start);
+        }
+        ++start;
+    }
+    return (NULL);
+}
+
+static const ::System::Char * FindLastShortStringScalar(const ::System::Char * start, const ::System::Char * end, const ::System::Char * needle, ::System::Int32 needleLength)
+{
+    CROSSNET_ASSERT(needleLength >= 2, "");
+    ::System::Char first = needle[0];
+    for (::System::Int32 i = (::System::Int32)(end - start) - needleLength ; i >= 0 ; --i)
+    {
+        if ((start[i] == first) && MatchesAt(start + i + 1, needle + 1, needleLength - 1))
+        {
+            return (start + i);
+        }
+    }
+    return (NULL);
+}
+
+static const ::System::Char * SkipLastWhiteSpacesScalar(const ::System::Char * start, const ::System::Char * end)
+{
+    while ((start < end) && StringSearch::IsWhiteSpace(end[-1]))
+    {
+        --end;
+    }
+    return (end);
+}
+
+#if CROSSNET_STRING_SSE2
+
+// SSE2 versions
+//  The blocks are loaded unaligned, the string buffer is not aligned on 16 bytes (and neither are the start indexes).
+//  The comparisons work on 8 characters at a time, _mm_movemask_epi8() returns 2 bits per character.
+
+static const int CHARS_PER_BLOCK = sizeof(__m128i) / sizeof(::System::Char);
+
+// More characters than that and FindAnyChar() uses the scalar version with the bitmap
+//  (SSE2 has no byte shuffle to do a table lookup, each character of the set costs one comparison per block)
+static const int MAX_SSE2_SET_SIZE = 4;
+
+CROSSNET_FINLINE
+static int FirstCharIndex(int mask)
+{
+    unsigned long index;
+    _BitScanForward(&index, (unsigned long)mask);
+    return ((int)(index >> 1));
+}
+
+CROSSNET_FINLINE
+static int LastCharIndex(int mask)
+{
+    unsigned long index;
+    _BitScanReverse(&index, (unsigned long)mask);
+    return ((int)(index >> 1));
+}
+
+CROSSNET_FINLINE
+static __m128i LoadBlock(const ::System::Char * buffer)
+{
+    return (_mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer)));
+}
+
+// Returns the movemask of the white spaces (0x09 to 0x0d and 0x20) in the block
+CROSSNET_FINLINE
+static int WhiteSpaceMask(__m128i block)
+{
+    // Unsigned saturation: (c - 0x09) <= 4 <=> saturated (c - 0x09 - 4) == 0, anything below 0x09 wraps to a big value
+    __m128i shifted = _mm_sub_epi16(block, _mm_set1_epi16(0x09));
+    __m128i inRange = _mm_cmpeq_epi16(_mm_subs_epu16(shifted, _mm_set1_epi16(0x0d - 0x09)), _mm_setzero_si128());
+    __m128i space = _mm_cmpeq_epi16(block, _mm_set1_epi16(0x20));
+    return (_mm_movemask_epi8(_mm_or_si128(inRange, space)));
+}
+
+static const int FULL_MASK = 0xffff;
+
+static const ::System::Char * FindCharSSE2(const ::System::Char * start, const ::System::Char * end, ::System::Char c)
+{
+    __m128i pattern = _mm_set1_epi16((short)c);
+    while ((end - start) >= CHARS_PER_BLOCK)
+    {
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi16(LoadBlock(start), pattern));
+        if (mask != 0)
+        {
+            return (start + FirstCharIndex(mask));
+        }
+        start += CHARS_PER_BLOCK;
+    }
+    return (FindCharScalar(start, end, c));
+}
+
+static const ::System::Char * FindLastCharSSE2(const ::System::Char * start, const ::System::Char * end, ::System::Char c)
+{
+    __m128i pattern = _mm_set1_epi16((short)c);
+    while ((end - start) >= CHARS_PER_BLOCK)
+    {
+        end -= CHARS_PER_BLOCK;
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi16(LoadBlock(end), pattern));
+        if (mask != 0)
+        {
+            return (end + LastCharIndex(mask));
+        }
+    }
+    return (FindLastCharScalar(start, end, c));
+}
+
+// Broadcasts each character of the small set, the missing ones are replaced by the first character
+CROSSNET_FINLINE
+static void GetSetPatterns(const CharSet & set, __m128i * patterns)
+{
+    CROSSNET_ASSERT((set.mLength > 0) && (set.mLength <= MAX_SSE2_SET_SIZE), "");
+    for (int i = 0 ; i < MAX_SSE2_SET_SIZE ; ++i)
+    {
+        ::System::Char c = (i < set.mLength) ? set.mChars[i] : set.mChars[0];
+        patterns[i] = _mm_set1_epi16((short)c);
+    }
+}
+
+CROSSNET_FINLINE
+static int SetMask(__m128i block, const __m128i * patterns)
+{
+    __m128i result = _mm_or_si128(_mm_cmpeq_epi16(block, patterns[0]), _mm_cmpeq_epi16(block, patterns[1]));
+    result = _mm_or_si128(result, _mm_cmpeq_epi16(block, patterns[2]));
+    result = _mm_or_si128(result, _mm_cmpeq_epi16(block, patterns[3]));
+    return (_mm_movemask_epi8(result));
+}
+
+static const ::System::Char * FindAnyCharSSE2(const ::System::Char * start, const ::System::Char * end, const CharSet & set)
+{
+    if ((set.mLength == 0) || (set.mLength > MAX_SSE2_SET_SIZE))
+    {
+        return (FindAnyCharScalar(start, end, set));
+    }
+    __m128i patterns[MAX_SSE2_SET_SIZE];
+    GetSetPatterns(set, patterns);
+    while ((end - start) >= CHARS_PER_BLOCK)
+    {
+        int mask = SetMask(LoadBlock(start), patterns);
+        if (mask != 0)
+        {
+            return (start + FirstCharIndex(mask));
+        }
+        start += CHARS_PER_BLOCK;
+    }
+    return (FindAnyCharScalar(start, end, set));
+}
+
+static const ::System::Char * FindLastAnyCharSSE2(const ::System::Char * start, const ::System::Char * end, const CharSet & set)
+{
+    if ((set.mLength == 0) || (set.mLength > MAX_SSE2_SET_SIZE))
+    {
+        return (FindLastAnyCharScalar(start, end, set));
+    }
+    __m128i patterns[MAX_SSE2_SET_SIZE];
+    GetSetPatterns(set, patterns);
+    while ((end - start) >= CHARS_PER_BLOCK)
+    {
+        end -= CHARS_PER_BLOCK;
+        int mask = SetMask(LoadBlock(end), patterns);
+        if (mask != 0)
+        {
+            return (end + LastCharIndex(mask));
+        }
+    }
+    return (FindLastAnyCharScalar(start, end, set));
+}
+
+static const ::System::Char * SkipWhiteSpacesSSE2(const ::System::Char * start, const ::System::Char * end)
+{
+    while ((end - start) >= CHARS_PER_BLOCK)
+    {
+        int mask = WhiteSpaceMask(LoadBlock(start));
+        if (mask != FULL_MASK)
+        {
+            return (start + FirstCharIndex(~mask & FULL_MASK));
+        }
+        start += CHARS_PER_BLOCK;
+    }
+    return (SkipWhiteSpacesScalar(start, end));
+}
+
+static const ::System::Char * SkipLastWhiteSpacesSSE2(const ::System::Char * start, const ::System::Char * end)
+{
+    while ((end - start) >= CHARS_PER_BLOCK)
+    {
+        const ::System::Char * block = end - CHARS_PER_BLOCK;
+        int mask = WhiteSpaceMask(LoadBlock(block));
+        if (mask != FULL_MASK)
+        {
+            return (block + LastCharIndex(~mask & FULL_MASK) + 1);
+        }
+        end = block;
+    }
+    return (SkipLastWhiteSpacesScalar(start, end));
+}
+
+static ::System::Int32 FindMismatchSSE2(const ::System::Char * a, const ::System::Char * b, ::System::Int32 length)
+{
+    ::System::Int32 i = 0;
+    while ((length - i) >= CHARS_PER_BLOCK)
+    {
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi16(LoadBlock(a + i), LoadBlock(b + i)));
+        if (mask != FULL_MASK)
+        {
+            return (i + FirstCharIndex(~mask & FULL_MASK));
+        }
+        i += CHARS_PER_BLOCK;
+    }
+    return (i + FindMismatchScalar(a + i, b + i, length - i));
+}
+
+// Looks for the first and the last characters of the needle at the same time, 8 positions per block
+//  Then the few candidates are verified with a comparison of the rest of the needle
+static const ::System::Char * FindShortStringSSE2(const ::System::Char * start, const ::System::Char * end, const ::System::Char * needle, ::System::Int32 needleLength)
+{
+    CROSSNET_ASSERT(needleLength >= 2, "");
+    __m128i first = _mm_set1_epi16((short)needle[0]);
+    __m128i last = _mm_set1_epi16((short)needle[needleLength - 1]);
+    // The last block of the last character must stay in the range
+    while ((end - start) >= needleLength + CHARS_PER_BLOCK - 1)
+    {
+        __m128i firstMatches = _mm_cmpeq_epi16(LoadBlock(start), first);
+        __m128i lastMatches = _mm_cmpeq_epi16(LoadBlock(start + needleLength - 1), last);
+        int mask = _mm_movemask_epi8(_mm_and_si128(firstMatches, lastMatches));
+        while (mask != 0)
+        {
+            int index = FirstCharIndex(mask);
+            if (MatchesAt(start + index + 1, needle + 1, needleLength - 2))
+            {
+                return (start + index);
+            }
+            mask &= ~(3 << (index * 2));
+        }
+        start += CHARS_PER_BLOCK;
+    }
+    return (FindShortStringScalar(start, end, needle, needleLength));
+}
+
+static const ::System::Char * FindLastShortStringSSE2(const ::System::Char * start, const ::System::Char * end, const ::System::Char * needle, ::System::Int32 needleLength)
+{
+    CROSSNET_ASSERT(needleLength >= 2, "");
+    __m128i first = _mm_set1_epi16((short)needle[0]);
+    __m128i last = _mm_set1_epi16((short)needle[needleLength - 1]);
+    // Each block tests the 8 positions before lastPosition (included)
+    ::System::Int32 lastPosition = (::System::Int32)(end - start) - needleLength;
+    while (lastPosition >= CHARS_PER_BLOCK - 1)
+    {
+        const ::System::Char * block = start + lastPosition - (CHARS_PER_BLOCK - 1);
+        __m128i firstMatches = _mm_cmpeq_epi16(LoadBlock(block), first);
+        __m128i lastMatches = _mm_cmpeq_epi16(LoadBlock(block + needleLength - 1), last);
+        int mask = _mm_movemask_epi8(_mm_and_si128(firstMatches, lastMatches));
+        while (mask != 0)
+        {
+            int index = LastCharIndex(mask);
+            if (MatchesAt(block + index + 1, needle + 1, needleLength - 2))
+            {
+                return (block + index);
+            }
+            mask &= ~(3 << (index * 2));
+        }
+        lastPosition -= CHARS_PER_BLOCK;
+    }
+    if (lastPosition < 0)
+    {
+        return (NULL);
+    }
+    return (FindLastShortStringScalar(start, start + lastPosition + needleLength, needle, needleLength));
+}
+
+static bool HasSSE2()
+{
+#if defined(_M_X64)
+    // Every x64 CPU has SSE2
+    return (true);
+#else
+    int info[4];
+    __cpuid(info, 1);
+    return ((info[3] & (1 << 26)) != 0);
+#endif
+}
+
+#endif
+
+// Use the scalar versions until Setup() is called, so the strings created before are handled correctly
+StringSearch::FindCharFunctionPointer       StringSearch::sFindChar = FindCharScalar;
+StringSearch::FindCharFunctionPointer       StringSearch::sFindLastChar = FindLastCharScalar;
+StringSearch::FindAnyCharFunctionPointer    StringSearch::sFindAnyChar = FindAnyCharScalar;
+StringSearch::FindAnyCharFunctionPointer    StringSearch::sFindLastAnyChar = FindLastAnyCharScalar;
+StringSearch::SkipFunctionPointer           StringSearch::sSkipWhiteSpaces = SkipWhiteSpacesScalar;
+StringSearch::SkipFunctionPointer           StringSearch::sSkipLastWhiteSpaces = SkipLastWhiteSpacesScalar;
+StringSearch::FindMismatchFunctionPointer   StringSearch::sFindMismatch = FindMismatchScalar;
+StringSearch::FindStringFunctionPointer     StringSearch::sFindShortString = FindShortStringScalar;
+StringSearch::FindStringFunctionPointer     StringSearch::sFindLastShortString = FindLastShortStringScalar;
+
+void StringSearch::Setup(const InitOptions & /*options*/)
+{
+#if CROSSNET_STRING_SSE2
+    if (HasSSE2())
+    {
+        sFindChar = FindCharSSE2;
+        sFindLastChar = FindLastCharSSE2;
+        sFindAnyChar = FindAnyCharSSE2;
+        sFindLastAnyChar = FindLastAnyCharSSE2;
+        sSkipWhiteSpaces = SkipWhiteSpacesSSE2;
+        sSkipLastWhiteSpaces = SkipLastWhiteSpacesSSE2;
+        sFindMismatch = FindMismatchSSE2;
+        sFindShortString = FindShortStringSSE2;
+        sFindLastShortString = FindLastShortStringSSE2;
+    }
+#endif
+}
+
+bool StringSearch::IsUsingSSE2()
+{
+    return (sFindChar != FindCharScalar);
+}
+
+const ::System::Char * StringSearch::FindString(const ::System::Char * start, const ::System::Char * end, const ::System::Char * needle, ::System::Int32 needleLength)
+{
+    StringSearcher searcher(needle, needleLength);
+    return (searcher.Find(start, end));
+}
+
+const ::System::Char * StringSearch::FindLastString(const ::System::Char * start, const ::System::Char * end, const ::System::Char * needle, ::System::Int32 needleLength)
+{
+    StringSearcher searcher(needle, needleLength);
+    return (searcher.FindLast(start, end));
+}
+
+StringSearcher::StringSearcher(const ::System::Char * needle, ::System::Int32 needleLength)
+    :
+    mNeedle(needle),
+    mNeedleLength(needleLength)
+{
+    CROSSNET_ASSERT(needleLength >= 0, "");
+    if (needleLength <= MAX_SHORT_NEEDLE_LENGTH)
+    {
+        // The skip tables are not used
+        return;
+    }
+
+    // mSkip is used when the search goes forward, it is based on the last character of the current window
+    //  mLastSkip is used when the search goes backward, it is based on the first character of the current window
+    for (int i = 0 ; i < 256 ; ++i)
+    {
+        mSkip[i] = needleLength;
+        mLastSkip[i] = needleLength;
+    }
+    // The later characters overwrite the earlier ones with the same low byte, so the smallest skip is kept
+    for (int i = 0 ; i < needleLength - 1 ; ++i)
+    {
+        mSkip[needle[i] & 0xff] = needleLength - 1 - i;
+    }
+    for (int i = needleLength - 1 ; i >= 1 ; --i)
+    {
+        mLastSkip[needle[i] & 0xff] = i;
+    }
+}
+
+const ::System::Char * StringSearcher::Find(const ::System::Char * start, const ::System::Char * end) const
+{
+    ::System::Int32 needleLength = mNeedleLength;
+    ::System::Int32 lastPosition = (::System::Int32)(end - start) - needleLength;
+    if (lastPosition < 0)
+    {
+        return (NULL);
+    }
+    switch (needleLength)
+    {
+    case 0:
+        return (start);
+    case 1:
+        return (StringSearch::FindChar(start, end, mNeedle[0]));
+    default:
+        break;
+    }
+    if (needleLength <= MAX_SHORT_NEEDLE_LENGTH)
+    {
+        return (StringSearch::sFindShortString(start, end, mNeedle, needleLength));
+    }
+
+    ::System::Char lastChar = mNeedle[needleLength - 1];
+    ::System::Int32 position = 0;
+    while (position <= lastPosition)
+    {
+        ::System::Char c = start[position + needleLength - 1];
+        if ((c == lastChar) && MatchesAt(start + position, mNeedle, needleLength - 1))
+        {
+            return (start + position);
+        }
+        position += mSkip[c & 0xff];
+    }
+    return (NULL);
+}
+
+const ::System::Char * StringSearcher::FindLast(const ::System::Char * start, const ::System::Char * end) const
+{
+    ::System::Int32 needleLength = mNeedleLength;
+    ::System::Int32 position = (::System::Int32)(end - start) - needleLength;
+    if (position < 0)
+    {
+        return (NULL);
+    }
+    switch (needleLength)
+    {
+    case 0:
+        return (end);
+    case 1:
+        return (StringSearch::FindLastChar(start, end, mNeedle[0]));
+    default:
+        break;
+    }
+    if (needleLength <= MAX_SHORT_NEEDLE_LENGTH)
+    {
+        return (StringSearch::sFindLastShortString(start, end, mNeedle, needleLength));
+    }
+
+    ::System::Char firstChar = mNeedle[0];
+    while (position >= 0)
+    {
+        ::System::Char c = start[position];
+        if ((c == firstChar) && MatchesAt(start + position + 1, mNeedle + 1, needleLength - 1))
+        {
+            return (start + position);
+        }
+        position -= mLastSkip[c & 0xff];
+    }
+    return (NULL);
+}
+
+}
@@ -22,6 +22,7 @@ void * * System::Object::s__InterfaceMap__ = NULL;
 void System::Object::__RegisterId__()
 {
     s__InterfaceMap__ = CrossNetRuntime::InterfaceMapper::RegisterObjectStaticId(__GetId__(), sizeof(System::Object));
+    CrossNetRuntime::InterfaceMapper::SetReferenceOffsets(s__InterfaceMap__, CrossNetRuntime::NO_REFERENCE_OFFSETS);
 }
 
 // Will have to be implemented somewhere else... (Once System::Type is defined...)
@@ -33,8 +34,35 @@ System::String * System::Object::ToString()
 
 void * System::Object::__Cast__(int iid)
 {
-    void * * interfaceMap = m__InterfaceMap__;
+    if (__CanCast__(m__InterfaceMap__, iid))
+    {
+        // Any interface or class is pointing to the same address
+        return (this);
+    }
+    // Didn't find what we were looking for...
+    return (NULL);
+}
+
+bool System::Object::__CanCast__(void * * interfaceMap, void * * targetInterfaceMap)
+{
+    int iid = CrossNetRuntime::InterfaceMapper::GetId(targetInterfaceMap);
+    if (iid > 0)
+    {
+        // Interfaces are not part of the class display, look at the interface list
+        return (__CanCast__(interfaceMap, iid));
+    }
 
+    if (CrossNetRuntime::InterfaceMapper::IsSameOrSubclass(interfaceMap, targetInterfaceMap))
+    {
+        return (true);
+    }
+
+    // Some runtime types are registered without parent, System::Object is then implicit
+    return (iid == System::Object::__GetId__());
+}
+
+bool System::Object::__CanCast__(void * * interfaceMap, int iid)
+{
     int *   interfaceList;
     int     numComparisons;
 
@@ -49,6 +77,13 @@ void * System::Object::__Cast__(int iid)
 
     if (iid > 0)
     {
+        if (CrossNetRuntime::InterfaceMapper::GetId(interfaceMap) <= 0)
+        {
+            // This is a class, it has a wrapper for each interface implemented
+            // So we don't have to look at the list, we just check that the wrapper slot belongs to the class
+            return (CrossNetRuntime::InterfaceMapper::Implements(interfaceMap, iid));
+        }
+
         // We are looking for a cast with interfaces
         numComparisons = CrossNetRuntime::InterfaceMapper::GetNumInterfaces(interfaceMap);
         interfaceList = CrossNetRuntime::InterfaceMapper::GetInterfaceList(interfaceMap);
@@ -61,7 +96,7 @@ void * System::Object::__Cast__(int iid)
         // As that's the most probable cast - and is not in the implementation list anyway...
         if (iid == CrossNetRuntime::InterfaceMapper::GetId(interfaceMap))
         {
-            return (this);
+            return (true);
         }
 
         // No luck, let's see if we can compare with the base implementations
@@ -80,7 +115,7 @@ void * System::Object::__Cast__(int iid)
         if (*interfaceList-- == iid)
         {
             // Found it!
-            return (this);
+            return (true);
         }
     }
 
@@ -89,9 +124,9 @@ void * System::Object::__Cast__(int iid)
     // But this can happen during asserts or possibly some generic operations (would have to prove it though).
     if (iid == System::Object::__GetId__())
     {
-        return (this);
+        return (true);
     }
 
     // Didn't find what we were looking for...
-    return (NULL);
+    return (false);
 }
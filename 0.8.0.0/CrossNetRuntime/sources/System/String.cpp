@@ -16,7 +16,10 @@
 #include "CrossNetRuntime/System/String.h"
 
 #include "CrossNetRuntime/CrossNetRuntime.h"
+#include "CrossNetRuntime/CompositeFormat.h"
+#include "CrossNetRuntime/StringSearch.h"
 #include "CrossNetRuntime/Internal/BaseTypes.h"
+#include "CrossNetRuntime/Internal/Chars.h"
 #include "CrossNetRuntime/System/CharEnumerator.h"
 #include "CrossNetRuntime/System/StringComparison.h"
 #include "CrossNetRuntime/System/Text/StringBuilder.h"
@@ -40,6 +43,8 @@ void String::__RegisterId__()
         CN_IMPLEMENT(Wrapper__IEquatable__G1),
     };
     s__InterfaceMap__ = CrossNetRuntime::InterfaceMapper::RegisterObject(sizeof(System::String), info, sizeof(info) / sizeof(info[0]), NULL);
+    // The characters are not references, the GC doesn't have to call __Trace__()
+    CrossNetRuntime::InterfaceMapper::SetReferenceOffsets(s__InterfaceMap__, CrossNetRuntime::NO_REFERENCE_OFFSETS);
 
     // Call a specific function so we are not using the empty string (that we are trying to create)...
     Empty = String::__CreateEmpty__();
@@ -54,7 +59,7 @@ String::String(const System::Char * text, System::Int32 length)
     m__InterfaceMap__ = __GetInterfaceMap__();
     CROSSNET_ASSERT(m__InterfaceMap__ != NULL, "Incorrect init order for string!");
     mLength = length;
-    wmemcpy(mBuffer, text, mLength + 1);
+    CrossNetRuntime::CopyChars(mBuffer, text, mLength + 1);
 }
 
 String::String(System::Char c, int number)
@@ -65,8 +70,8 @@ String::String(System::Char c, int number)
     m__InterfaceMap__ = __GetInterfaceMap__();
     CROSSNET_ASSERT(m__InterfaceMap__ != NULL, "Incorrect init order for string!");
     mLength = number;
-    wmemset(mBuffer, c, mLength);
-    mBuffer[mLength] = L'\0';
+    CrossNetRuntime::FillChars(mBuffer, c, mLength);
+    mBuffer[mLength] = '\0';
 }
 
 String::String(System::Int32 size)
@@ -91,18 +96,18 @@ String::String(const System::Char * text, System::Int32 size, bool safe)
     if (safe)
     {
         mLength = size;
-        CROSSNET_ASSERT((System::Int32)wcslen(text) == size, "");
+        CROSSNET_ASSERT(CrossNetRuntime::GetCharLength(text) == size, "");
     }
     else
     {
-        Int32 length = (System::Int32)wcslen(text);
+        Int32 length = CrossNetRuntime::GetCharLength(text);
         mLength = length;
         if (mLength > size)
         {
             mLength = size;
         }
     }
-    wmemcpy(mBuffer, text, mLength + 1);
+    CrossNetRuntime::CopyChars(mBuffer, text, mLength + 1);
 }
 #endif
 
@@ -114,8 +119,8 @@ String::String(const System::Char * text, System::Int32 startIndex, System::Int3
     m__InterfaceMap__ = __GetInterfaceMap__();
     CROSSNET_ASSERT(m__InterfaceMap__ != NULL, "Incorrect init order for string!");
     mLength = size;
-    wmemcpy(mBuffer, text + startIndex, size);
-    mBuffer[mLength] = L'\0';
+    CrossNetRuntime::CopyChars(mBuffer, text + startIndex, size);
+    mBuffer[mLength] = '\0';
 }
 
 // Destructor can be private, this class is sealed...
@@ -127,7 +132,7 @@ String::~String()
 String * String::__CreateEmpty__()
 {
     String * empty = __Create__(1);
-    empty->mBuffer[0] = L'\0';
+    empty->mBuffer[0] = '\0';
     return (empty);
 }
 
@@ -137,7 +142,7 @@ String * String::__Create__(const System::Char * text)
     {
         return (Empty);
     }
-    int length = (System::Int32)wcslen(text);
+    int length = CrossNetRuntime::GetCharLength(text);
     String * temp = (String *)operator new(sizeof(String) + ((length + 1) * sizeof(System::Char)));
     temp->String::String(text, length);
     return (temp);
@@ -149,7 +154,7 @@ String * String::__Create__(System::Char * text, System::Int32 start, System::In
     {
         return (Empty);
     }
-    Int32 totalLength = (System::Int32)wcslen(text);
+    Int32 totalLength = CrossNetRuntime::GetCharLength(text);
     CROSSNET_ASSERT(totalLength >= start, "The startIndex is smaller than the length of the string!");
     int localLength = totalLength - start;
     if (localLength > length)
@@ -161,7 +166,7 @@ String * String::__Create__(System::Char * text, System::Int32 start, System::In
     return (temp);
 }
 
-String * String::__CreateWithLengthKnown__(System::Char * text, System::Int32 length)
+String * String::__CreateWithLengthKnown__(const System::Char * text, System::Int32 length)
 {
     if (length <= 0)
     {
@@ -199,92 +204,86 @@ String * String::__Create__(System::Int32 totalSize)
     return (temp);
 }
 
-String * String::Concat(const String * s1, const String * s2)
+String * String::__Concat__(const String * const * parts, System::Int32 count)
 {
-    System::Int32 size1 = s1->get_Length();
-    System::Int32 size2 = s2->get_Length();
-    System::Int32 bufferSize = size1 + size2 + 1;   // +1 for the trailing '\0'
-    System::String * concatString = __Create__(bufferSize);
+    // First calculate the total length, NULL strings are considered as empty strings
+    System::Int32 length = 0;
+    System::Int32 numNonEmptyParts = 0;
+    const String * nonEmptyPart = NULL;
+    for (System::Int32 i = 0 ; i < count ; ++i)
+    {
+        const String * part = parts[i];
+        if ((part != NULL) && (part->mLength != 0))
+        {
+            length += part->mLength;
+            nonEmptyPart = part;
+            ++numNonEmptyParts;
+        }
+    }
+    if (numNonEmptyParts <= 1)
+    {
+        // Like .Net, there is nothing to concatenate so we don't allocate anything
+        return ((nonEmptyPart != NULL) ? const_cast<String *>(nonEmptyPart) : Empty);
+    }
+
+    // Then allocate once and copy each part
+    System::String * concatString = __Create__(length + 1);     // +1 for the trailing '\0'
     System::Char * buffer = const_cast<System::Char *>(concatString->__ToCString__());
-    wmemcpy(buffer, s1->__ToCString__(), size1);
-    wmemcpy(buffer + size1, s2->__ToCString__(), size2 + 1);
+    for (System::Int32 i = 0 ; i < count ; ++i)
+    {
+        const String * part = parts[i];
+        if (part != NULL)
+        {
+            CrossNetRuntime::CopyChars(buffer, part->mBuffer, part->mLength);
+            buffer += part->mLength;
+        }
+    }
+    *buffer = 0;
+
+    CROSSNET_ASSERT(buffer == concatString->__ToCString__() + length, "");
     return (concatString);
 }
 
+// Like .Net, a NULL object is concatenated as an empty string
+static const String * ToStringOrNull(System::Object * obj)
+{
+    return ((obj != NULL) ? obj->ToString() : NULL);
+}
+
+String * String::Concat(const String * s1, const String * s2)
+{
+    const String * parts[] = { s1, s2 };
+    return (__Concat__(parts, 2));
+}
+
 String * String::Concat(const String * s1, const String * s2, const String * s3)
 {
-    System::Int32 size1 = s1->get_Length();
-    System::Int32 size2 = s2->get_Length();
-    System::Int32 size3 = s3->get_Length();
-    System::Int32 bufferSize = size1 + size2 + size3 + 1;   // +1 for the trailing '\0'
-    System::String * concatString = __Create__(bufferSize);
-    System::Char * buffer = const_cast<System::Char *>(concatString->__ToCString__());
-    wmemcpy(buffer, s1->__ToCString__(), size1);
-    wmemcpy(buffer + size1, s2->__ToCString__(), size2);
-    wmemcpy(buffer + (size1 + size2), s3->__ToCString__(), size3 + 1);
-    return (concatString);
+    const String * parts[] = { s1, s2, s3 };
+    return (__Concat__(parts, 3));
 }
 
 String * String::Concat(const String * s1, const String * s2, const String * s3, const String * s4)
 {
-    System::Int32 size1 = s1->get_Length();
-    System::Int32 size2 = s2->get_Length();
-    System::Int32 size3 = s3->get_Length();
-    System::Int32 size4 = s4->get_Length();
-    System::Int32 bufferSize = size1 + size2 + size3 + size4 + 1;   // +1 for the trailing '\0'
-    System::String * concatString = __Create__(bufferSize);
-    System::Char * buffer = const_cast<System::Char *>(concatString->__ToCString__());
-    wmemcpy(buffer, s1->__ToCString__(), size1);
-    wmemcpy(buffer + size1, s2->__ToCString__(), size2);
-    wmemcpy(buffer + (size1 + size2), s3->__ToCString__(), size3);
-    wmemcpy(buffer + (size1 + size2 + size3), s4->__ToCString__(), size4 + 1);
-    return (concatString);
+    const String * parts[] = { s1, s2, s3, s4 };
+    return (__Concat__(parts, 4));
 }
 
 String * String::Concat(System::Object * a, System::Object * b)
 {
-    System::String * s1 = a->ToString();
-    System::String * s2 = b->ToString();
-    return (Concat(s1, s2));
+    const String * parts[] = { ToStringOrNull(a), ToStringOrNull(b) };
+    return (__Concat__(parts, 2));
 }
 
 String * String::Concat(System::Object * a, System::Object * b, System::Object * c)
 {
-    System::String * s1 = a->ToString();
-    System::String * s2 = b->ToString();
-    System::String * s3 = c->ToString();
-
-    System::Int32 size1 = s1->get_Length();
-    System::Int32 size2 = s2->get_Length();
-    System::Int32 size3 = s3->get_Length();
-    System::Int32 bufferSize = size1 + size2 + size3 + 1;   // +1 for the trailing '\0'
-    System::String * concatString = __Create__(bufferSize);
-    System::Char * buffer = const_cast<System::Char *>(concatString->__ToCString__());
-    wmemcpy(buffer, s1->__ToCString__(), size1);
-    wmemcpy(buffer + size1, s2->__ToCString__(), size2);
-    wmemcpy(buffer + (size1 + size2), s3->__ToCString__(), size3 + 1);
-    return (concatString);
+    const String * parts[] = { ToStringOrNull(a), ToStringOrNull(b), ToStringOrNull(c) };
+    return (__Concat__(parts, 3));
 }
 
 String * String::Concat(System::Object * a, System::Object * b, System::Object * c, System::Object * d)
 {
-    System::String * s1 = a->ToString();
-    System::String * s2 = b->ToString();
-    System::String * s3 = c->ToString();
-    System::String * s4 = d->ToString();
-
-    System::Int32 size1 = s1->get_Length();
-    System::Int32 size2 = s2->get_Length();
-    System::Int32 size3 = s3->get_Length();
-    System::Int32 size4 = s4->get_Length();
-    System::Int32 bufferSize = size1 + size2 + size3 + size4 + 1;   // +1 for the trailing '\0'
-    System::String * concatString = __Create__(bufferSize);
-    System::Char * buffer = const_cast<System::Char *>(concatString->__ToCString__());
-    wmemcpy(buffer, s1->__ToCString__(), size1);
-    wmemcpy(buffer + size1, s2->__ToCString__(), size2);
-    wmemcpy(buffer + (size1 + size2), s3->__ToCString__(), size3);
-    wmemcpy(buffer + (size1 + size2 + size3), s4->__ToCString__(), size4 + 1);
-    return (concatString);
+    const String * parts[] = { ToStringOrNull(a), ToStringOrNull(b), ToStringOrNull(c), ToStringOrNull(d) };
+    return (__Concat__(parts, 4));
 }
 
 System::Int32 String::GetHashCode()
@@ -341,7 +340,8 @@ int String::Compare(const String * a, const String * b)
         return (1);
     }
     // So here a and b are not NULL
-    return (wcscmp(a->__ToCString__(), b->__ToCString__()));
+    //  The runtime doesn't handle the cultures, so this is an ordinal comparison that uses the known lengths
+    return (CompareOrdinal(a->mBuffer, a->mLength, b->mBuffer, b->mLength));
 }
 
 System::Int32 String::Compare(const System::String * a, const System::String * b, bool ignoreCase)
@@ -364,11 +364,11 @@ System::Int32 String::Compare(const System::String * a, const System::String * b
 
     if (ignoreCase)
     {
-        return (_wcsicmp(a->__ToCString__(), b->__ToCString__()));
+        return (CrossNetRuntime::CompareCharsIgnoreCase(a->mBuffer, a->mLength, b->mBuffer, b->mLength));
     }
     else
     {
-        return (wcscmp(a->__ToCString__(), b->__ToCString__()));
+        return (CompareOrdinal(a->mBuffer, a->mLength, b->mBuffer, b->mLength));
     }
 }
 
@@ -392,12 +392,79 @@ System::Int32 String::Compare(const String * /*a*/, const String * /*b*/, System
 
 System::Boolean String::Equals(System::Object * obj)
 {
-    System::String * other = CrossNetRuntime::AsCast<System::String>(obj);
-    if (other == NULL)
+    if (obj == this)
+    {
+        return (true);
+    }
+    // String is sealed, there is no need to go through the full cast to know if obj is a string
+    if ((obj == NULL) || (obj->m__InterfaceMap__ != s__InterfaceMap__))
     {
         return (false);
     }
-    return (op_Equality(this, other));
+    return (op_Equality(this, static_cast<System::String *>(obj)));
+}
+
+bool String::__EqualsChars__(const String * a, const String * b)
+{
+    CROSSNET_ASSERT(a->mLength == b->mLength, "");
+    System::Int32 length = a->mLength;
+    return (CrossNetRuntime::StringSearch::FindMismatch(a->mBuffer, b->mBuffer, length) == length);
+}
+
+System::Int32 String::CompareOrdinal(System::String * strA, System::String * strB)
+{
+    if (strA == strB)
+    {
+        return (0);
+    }
+    else if (strA == NULL)
+    {
+        return (-1);
+    }
+    else if (strB == NULL)
+    {
+        return (1);
+    }
+    return (CompareOrdinal(strA->mBuffer, strA->mLength, strB->mBuffer, strB->mLength));
+}
+
+System::Int32 String::CompareOrdinal(System::String * strA, System::Int32 indexA, System::String * strB, System::Int32 indexB, System::Int32 length)
+{
+    if (strA == NULL)
+    {
+        return ((strB == NULL) ? 0 : -1);
+    }
+    else if (strB == NULL)
+    {
+        return (1);
+    }
+    CROSSNET_ASSERT((indexA >= 0) && (indexA <= strA->mLength), "Out of bound!");
+    CROSSNET_ASSERT((indexB >= 0) && (indexB <= strB->mLength), "Out of bound!");
+    CROSSNET_ASSERT(length >= 0, "");
+    // Like .NET, compare at most length characters of each string
+    System::Int32 lengthA = strA->mLength - indexA;
+    if (lengthA > length)
+    {
+        lengthA = length;
+    }
+    System::Int32 lengthB = strB->mLength - indexB;
+    if (lengthB > length)
+    {
+        lengthB = length;
+    }
+    return (CompareOrdinal(strA->mBuffer + indexA, lengthA, strB->mBuffer + indexB, lengthB));
+}
+
+System::Int32 String::CompareOrdinal(const System::Char * a, System::Int32 lengthA, const System::Char * b, System::Int32 lengthB)
+{
+    System::Int32 length = (lengthA < lengthB) ? lengthA : lengthB;
+    System::Int32 index = CrossNetRuntime::StringSearch::FindMismatch(a, b, length);
+    if (index < length)
+    {
+        // The characters are compared as unsigned 16 bits values
+        return ((System::Int32)(System::UInt16)a[index] - (System::Int32)(System::UInt16)b[index]);
+    }
+    return (lengthA - lengthB);
 }
 
 System::Int32 String::CompareTo(System::Object * value)
@@ -407,87 +474,344 @@ System::Int32 String::CompareTo(System::Object * value)
     {
         return (+1);
     }
-    return (wcscmp(__ToCString__(), other->__ToCString__()));
+    return (Compare(this, other));
 }
 
 System::String * String::Trim()
 {
-    Int32   length = mLength;
-    Char *  start = mBuffer;
-    Char *  end = mBuffer + length;
+    const Char * start = CrossNetRuntime::StringSearch::SkipWhiteSpaces(mBuffer, mBuffer + mLength);
+    // Then skip the end (knowing that start maybe already reached end...
+    const Char * end = CrossNetRuntime::StringSearch::SkipLastWhiteSpaces(start, mBuffer + mLength);
+    return (__SubString__(start, end));
+}
 
-    // First skip all the start
-    while (start < end)
+System::String * String::Trim(System::Array__G<System::Char> * trimChars)
+{
+    if ((trimChars == NULL) || (trimChars->get_Length() == 0))
     {
-        Char c = *start;
-        switch (c)
-        {
-        case 0x0009:
-        case 0x000a:
-        case 0x000b:
-        case 0x000c:
-        case 0x000d:
-        case 0x0020:
-            ++start;
-            continue;
-        }
+        return (Trim());
+    }
+    CrossNetRuntime::CharSet set(trimChars->__ToPointer__(), trimChars->get_Length());
+    const Char * start = SkipChars(mBuffer, mBuffer + mLength, set);
+    const Char * end = SkipLastChars(start, mBuffer + mLength, set);
+    return (__SubString__(start, end));
+}
 
-        // It's not a white space, stop this loop...
-        break;
+System::String * String::TrimStart(System::Array__G<System::Char> * trimChars)
+{
+    const Char * start;
+    if ((trimChars == NULL) || (trimChars->get_Length() == 0))
+    {
+        start = CrossNetRuntime::StringSearch::SkipWhiteSpaces(mBuffer, mBuffer + mLength);
+    }
+    else
+    {
+        CrossNetRuntime::CharSet set(trimChars->__ToPointer__(), trimChars->get_Length());
+        start = SkipChars(mBuffer, mBuffer + mLength, set);
     }
+    return (__SubString__(start, mBuffer + mLength));
+}
 
-    // Then skip the end (knowing that start maybe already reached end...
-    while (start < end)
+System::String * String::TrimEnd(System::Array__G<System::Char> * trimChars)
+{
+    const Char * end;
+    if ((trimChars == NULL) || (trimChars->get_Length() == 0))
     {
-        --end;
-        Char c = *end;
-        switch (c)
-        {
-        case 0x0009:
-        case 0x000a:
-        case 0x000b:
-        case 0x000c:
-        case 0x000d:
-        case 0x0020:
-            continue;
-        }
+        end = CrossNetRuntime::StringSearch::SkipLastWhiteSpaces(mBuffer, mBuffer + mLength);
+    }
+    else
+    {
+        CrossNetRuntime::CharSet set(trimChars->__ToPointer__(), trimChars->get_Length());
+        end = SkipLastChars(mBuffer, mBuffer + mLength, set);
+    }
+    return (__SubString__(mBuffer, end));
+}
 
-        // It's not a white space, stop this loop...
-        ++end;      // Readjust the end (so it won't be part of the string)
-        break;
+const System::Char * String::SkipChars(const System::Char * start, const System::Char * end, const CrossNetRuntime::CharSet & set)
+{
+    while ((start < end) && set.Contains(*start))
+    {
+        ++start;
     }
+    return (start);
+}
 
-    // So the new string is between start and end (char on end is not included)
+const System::Char * String::SkipLastChars(const System::Char * start, const System::Char * end, const CrossNetRuntime::CharSet & set)
+{
+    while ((start < end) && set.Contains(end[-1]))
+    {
+        --end;
+    }
+    return (end);
+}
 
-    if ((start == mBuffer) && (end == mBuffer + length))
+System::String * String::__SubString__(const System::Char * start, const System::Char * end)
+{
+    CROSSNET_ASSERT((start >= mBuffer) && (start <= end) && (end <= mBuffer + mLength), "Invalid sub-string!");
+    if ((start == mBuffer) && (end == mBuffer + mLength))
     {
         // Didn't trim anything... Return the same string
         return (this);
     }
+    // The length is known, no need to look for the trailing '\0' (the string can contain some zeros anyway)
+    return (__CreateWithLengthKnown__(start, (Int32)(end - start)));
+}
 
-    // We trim something, recreate a new string...
-    Int32 startIndex = (Int32)(start - mBuffer);
-    Int32 size = (Int32)(end - start);
-    return (__Create__(mBuffer, startIndex, size));
+// Converts the position returned by the search primitives to an index
+CROSSNET_FINLINE
+static System::Int32 ToIndex(const System::Char * found, const System::Char * buffer)
+{
+    if (found == NULL)
+    {
+        return (-1);
+    }
+    return ((System::Int32)(found - buffer));
 }
 
 System::Int32 String::IndexOf(System::Char c)
 {
     // Because of possible character zero, we cannot use standard C function here
-    System::Char * pointer = mBuffer;
-    System::Char * endBuffer = mBuffer + mLength;
-    while (pointer < endBuffer)
+    return (ToIndex(CrossNetRuntime::StringSearch::FindChar(mBuffer, mBuffer + mLength, c), mBuffer));
+}
+
+System::Int32 String::IndexOf(System::Char c, System::Int32 startIndex)
+{
+    return (IndexOf(c, startIndex, mLength - startIndex));
+}
+
+System::Int32 String::IndexOf(System::Char c, System::Int32 startIndex, System::Int32 count)
+{
+    CROSSNET_ASSERT((startIndex >= 0) && (startIndex <= mLength), "Out of bound!");
+    CROSSNET_ASSERT((count >= 0) && (count <= mLength - startIndex), "Out of bound!");
+    const Char * start = mBuffer + startIndex;
+    return (ToIndex(CrossNetRuntime::StringSearch::FindChar(start, start + count, c), mBuffer));
+}
+
+System::Int32 String::LastIndexOf(System::Char c)
+{
+    return (ToIndex(CrossNetRuntime::StringSearch::FindLastChar(mBuffer, mBuffer + mLength, c), mBuffer));
+}
+
+System::Int32 String::LastIndexOf(System::Char c, System::Int32 startIndex)
+{
+    return (LastIndexOf(c, startIndex, startIndex + 1));
+}
+
+System::Int32 String::LastIndexOf(System::Char c, System::Int32 startIndex, System::Int32 count)
+{
+    // The search goes backward, from startIndex to (startIndex - count + 1)
+    if (mLength == 0)
     {
-        if (*pointer == c)
+        return (-1);
+    }
+    CROSSNET_ASSERT((startIndex >= 0) && (startIndex < mLength), "Out of bound!");
+    CROSSNET_ASSERT((count >= 0) && (count <= startIndex + 1), "Out of bound!");
+    const Char * end = mBuffer + startIndex + 1;
+    return (ToIndex(CrossNetRuntime::StringSearch::FindLastChar(end - count, end, c), mBuffer));
+}
+
+System::Int32 String::IndexOfAny(System::Array__G<System::Char> * anyOf)
+{
+    return (IndexOfAny(anyOf, 0, mLength));
+}
+
+System::Int32 String::IndexOfAny(System::Array__G<System::Char> * anyOf, System::Int32 startIndex)
+{
+    return (IndexOfAny(anyOf, startIndex, mLength - startIndex));
+}
+
+System::Int32 String::IndexOfAny(System::Array__G<System::Char> * anyOf, System::Int32 startIndex, System::Int32 count)
+{
+    CROSSNET_ASSERT(anyOf != NULL, "");
+    CROSSNET_ASSERT((startIndex >= 0) && (startIndex <= mLength), "Out of bound!");
+    CROSSNET_ASSERT((count >= 0) && (count <= mLength - startIndex), "Out of bound!");
+    CrossNetRuntime::CharSet set(anyOf->__ToPointer__(), anyOf->get_Length());
+    const Char * start = mBuffer + startIndex;
+    return (ToIndex(CrossNetRuntime::StringSearch::FindAnyChar(start, start + count, set), mBuffer));
+}
+
+System::Int32 String::LastIndexOfAny(System::Array__G<System::Char> * anyOf)
+{
+    return (LastIndexOfAny(anyOf, mLength - 1, mLength));
+}
+
+System::Int32 String::LastIndexOfAny(System::Array__G<System::Char> * anyOf, System::Int32 startIndex)
+{
+    return (LastIndexOfAny(anyOf, startIndex, startIndex + 1));
+}
+
+System::Int32 String::LastIndexOfAny(System::Array__G<System::Char> * anyOf, System::Int32 startIndex, System::Int32 count)
+{
+    CROSSNET_ASSERT(anyOf != NULL, "");
+    if (mLength == 0)
+    {
+        return (-1);
+    }
+    CROSSNET_ASSERT((startIndex >= 0) && (startIndex < mLength), "Out of bound!");
+    CROSSNET_ASSERT((count >= 0) && (count <= startIndex + 1), "Out of bound!");
+    CrossNetRuntime::CharSet set(anyOf->__ToPointer__(), anyOf->get_Length());
+    const Char * end = mBuffer + startIndex + 1;
+    return (ToIndex(CrossNetRuntime::StringSearch::FindLastAnyChar(end - count, end, set), mBuffer));
+}
+
+// The string searches are ordinal, the runtime doesn't handle the cultures
+System::Int32 String::IndexOf(System::String * value)
+{
+    return (IndexOf(value, 0, mLength));
+}
+
+System::Int32 String::IndexOf(System::String * value, System::Int32 startIndex)
+{
+    return (IndexOf(value, startIndex, mLength - startIndex));
+}
+
+System::Int32 String::IndexOf(System::String * value, System::Int32 startIndex, System::Int32 count)
+{
+    CROSSNET_ASSERT(value != NULL, "");
+    CROSSNET_ASSERT((startIndex >= 0) && (startIndex <= mLength), "Out of bound!");
+    CROSSNET_ASSERT((count >= 0) && (count <= mLength - startIndex), "Out of bound!");
+    const Char * start = mBuffer + startIndex;
+    return (ToIndex(CrossNetRuntime::StringSearch::FindString(start, start + count, value->mBuffer, value->mLength), mBuffer));
+}
+
+System::Int32 String::LastIndexOf(System::String * value)
+{
+    return (LastIndexOf(value, mLength - 1, mLength));
+}
+
+System::Int32 String::LastIndexOf(System::String * value, System::Int32 startIndex)
+{
+    return (LastIndexOf(value, startIndex, startIndex + 1));
+}
+
+System::Int32 String::LastIndexOf(System::String * value, System::Int32 startIndex, System::Int32 count)
+{
+    // Like LastIndexOf(Char), the search goes backward from startIndex, the whole value must be within the count characters
+    CROSSNET_ASSERT(value != NULL, "");
+    if (mLength == 0)
+    {
+        return ((value->mLength == 0) ? 0 : -1);
+    }
+    CROSSNET_ASSERT((startIndex >= 0) && (startIndex < mLength), "Out of bound!");
+    CROSSNET_ASSERT((count >= 0) && (count <= startIndex + 1), "Out of bound!");
+    if (value->mLength == 0)
+    {
+        return (startIndex);
+    }
+    const Char * end = mBuffer + startIndex + 1;
+    return (ToIndex(CrossNetRuntime::StringSearch::FindLastString(end - count, end, value->mBuffer, value->mLength), mBuffer));
+}
+
+System::Boolean String::StartsWith(System::Char value)
+{
+    return ((mLength != 0) && (mBuffer[0] == value));
+}
+
+System::Boolean String::StartsWith(System::String * text)
+{
+    CROSSNET_ASSERT(text != NULL, "");
+    Int32 length = text->mLength;
+    if (length > mLength)
+    {
+        return (false);
+    }
+    return (__memcmp__(mBuffer, text->mBuffer, length * sizeof(Char)) == 0);
+}
+
+System::Boolean String::EndsWith(System::Char value)
+{
+    return ((mLength != 0) && (mBuffer[mLength - 1] == value));
+}
+
+System::Boolean String::EndsWith(System::String * text)
+{
+    CROSSNET_ASSERT(text != NULL, "");
+    Int32 length = text->mLength;
+    if (length > mLength)
+    {
+        return (false);
+    }
+    return (__memcmp__(mBuffer + (mLength - length), text->mBuffer, length * sizeof(Char)) == 0);
+}
+
+System::String * String::Replace(System::Char oldChar, System::Char newChar)
+{
+    const Char * end = mBuffer + mLength;
+    const Char * found = CrossNetRuntime::StringSearch::FindChar(mBuffer, end, oldChar);
+    if (found == NULL)
+    {
+        // Nothing to replace, strings are immutable so we can return the same one
+        return (this);
+    }
+
+    System::String * result = __CreateWithLengthKnown__(mBuffer, mLength);
+    Char * buffer = result->mBuffer;
+    Int32 index = (Int32)(found - mBuffer);
+    // The characters before the first occurrence are already correct
+    for (Int32 i = index ; i < mLength ; ++i)
+    {
+        if (buffer[i] == oldChar)
         {
-            return (pointer - mBuffer);
+            buffer[i] = newChar;
         }
-        ++pointer;
     }
-    return (-1);
+    return (result);
+}
+
+System::String * String::Replace(System::String * oldValue, System::String * newValue)
+{
+    CROSSNET_ASSERT((oldValue != NULL) && (oldValue->mLength != 0), "");
+    if (newValue == NULL)
+    {
+        newValue = Empty;
+    }
+
+    // The same needle is searched for every occurrence, prepare it once
+    Int32 oldLength = oldValue->mLength;
+    CrossNetRuntime::StringSearcher searcher(oldValue->mBuffer, oldLength);
+    const Char * end = mBuffer + mLength;
+
+    // First count the occurrences so the new string is allocated only once
+    int numberOfReplaces = 0;
+    const Char * current = searcher.Find(mBuffer, end);
+    while (current != NULL)
+    {
+        ++numberOfReplaces;
+        current = searcher.Find(current + oldLength, end);
+    }
+    if (numberOfReplaces == 0)
+    {
+        return (this);
+    }
+
+    Int32 newLength = newValue->mLength;
+    Int32 totalLength = mLength + numberOfReplaces * (newLength - oldLength);
+    if (totalLength == 0)
+    {
+        return (Empty);
+    }
+    System::String * result = __Create__(totalLength + 1);   // +1 for the trailing '\0'
+    Char * buffer = result->mBuffer;
+    const Char * copyStart = mBuffer;
+    current = searcher.Find(mBuffer, end);
+    while (current != NULL)
+    {
+        Int32 copySize = (Int32)(current - copyStart);
+        CrossNetRuntime::CopyChars(buffer, copyStart, copySize);
+        buffer += copySize;
+        CrossNetRuntime::CopyChars(buffer, newValue->mBuffer, newLength);
+        buffer += newLength;
+        copyStart = current + oldLength;
+        current = searcher.Find(copyStart, end);
+    }
+    Int32 size = (Int32)(end - copyStart);
+    CrossNetRuntime::CopyChars(buffer, copyStart, size);
+    buffer[size] = '\0';
+    CROSSNET_ASSERT(buffer + size == result->mBuffer + totalLength, "");
+    return (result);
 }
 
-System::Array__G<System::String *> * String::Split(System::Array__G<wchar_t> * array)
+System::Array__G<System::String *> * String::Split(System::Array__G<System::Char> * array)
 {
     System::Array__G<System::String *> * result;
     int arrayLength = array->get_Length();
@@ -499,24 +823,17 @@ System::Array__G<System::String *> * String::Split(System::Array__G<wchar_t> * a
         return (result);
     }
 
-    int i, j, length;
-    length = mLength;
+    CrossNetRuntime::CharSet set(array->__ToPointer__(), arrayLength);
+    const Char * end = mBuffer + mLength;
+    const Char * current;
 
     // First count the number of strings to create...
     int numberOfSplits = 0;
-    for (i = 0 ; i < length ; ++i)
+    current = CrossNetRuntime::StringSearch::FindAnyChar(mBuffer, end, set);
+    while (current != NULL)
     {
-        System::Char c = mBuffer[i];
-
-        for (j = 0 ; j < arrayLength ; ++j)
-        {
-            System::Char pattern = array->Item(j);
-            if (c == pattern)
-            {
-                ++numberOfSplits;
-                break;
-            }
-        }
+        ++numberOfSplits;
+        current = CrossNetRuntime::StringSearch::FindAnyChar(current + 1, end, set);
     }
 
     if (numberOfSplits == 0)
@@ -530,166 +847,91 @@ System::Array__G<System::String *> * String::Split(System::Array__G<wchar_t> * a
 
     // Now that the number of splist is determined, let's create the corresponding array
     result = System::Array__G<System::String *>::__Create__(numberOfSplits + 1);
-    int stringStart = 0; 
+    const Char * stringStart = mBuffer;
     int currentStringIndex = 0;
-    for (i = 0 ; i < length ; ++i)
+    current = CrossNetRuntime::StringSearch::FindAnyChar(mBuffer, end, set);
+    while (current != NULL)
     {
-        System::Char c = mBuffer[i];
-
-        for (j = 0 ; j < arrayLength ; ++j)
-        {
-            System::Char pattern = array->Item(j);
-            if (c == pattern)
-            {
-                int localLength = i - stringStart;
-                System::String * newString = __Create__(mBuffer, stringStart, localLength);
-                // Put the string and increment the counter
-                result->Item(currentStringIndex++) = newString;
-                stringStart = i + 1; // Skip the pattern
-                break;
-            }
-        }
+        System::String * newString = __CreateWithLengthKnown__(stringStart, (Int32)(current - stringStart));
+        // Put the string and increment the counter
+        result->Item(currentStringIndex++) = newString;
+        stringStart = current + 1;  // Skip the pattern
+        current = CrossNetRuntime::StringSearch::FindAnyChar(stringStart, end, set);
     }
 
     // And add the last string...
     {
-        int localLength = length - stringStart;
-        System::String * newString = String::__Create__(mBuffer, stringStart, localLength);
+        System::String * newString = __CreateWithLengthKnown__(stringStart, (Int32)(end - stringStart));
         // Put the string
         result->Item(currentStringIndex++) = newString;
     }
+    CROSSNET_ASSERT(currentStringIndex == numberOfSplits + 1, "");
 
     return (result);
 }
 
+// The builder buffer is given to the string without any copy, so start with a reasonable size
+static System::String * FormatArgs(System::IFormatProvider * provider, System::String * format, System::Object * const * args, System::Int32 numArgs)
+{
+    CROSSNET_ASSERT(format != NULL, "The format can't be NULL!");
+    System::Text::StringBuilder * strBuilder = System::Text::StringBuilder::__Create__(format->get_Length() + 8 * numArgs);
+    CrossNetRuntime::CompositeFormat::Append(strBuilder, provider, format, args, numArgs);
+    return (strBuilder->ToString());
+}
+
 System::String * String::Format(System::String * format, System::Object * arg0)
 {
-    System::String * string0 = NULL;    // By default the string is not initialized
+    return (FormatArgs(NULL, format, &arg0, 1));
+}
 
-    int i, length;
-    const System::Char * formatBuffer = format->__ToCString__();
-    length = format->get_Length();
-    System::Text::StringBuilder * strBuilder = System::Text::StringBuilder::__Create__(2 * length);
+System::String * String::Format(System::String * format, System::Object * arg0, System::Object * arg1)
+{
+    System::Object * args[] = { arg0, arg1 };
+    return (FormatArgs(NULL, format, args, 2));
+}
 
-    // TODO: Optimize this code...
-    // TODO: Improve parsing and error detection...
-    bool withinBraces = false;
-    const System::Char * afterStartBraces = NULL;
-    for (i = 0 ; i < length ; ++i)
-    {
-        System::Char c;
-        c = *formatBuffer++;
-        if (withinBraces)
-        {
-            if (c != L'}')
-            {
-                // Do nothing here...
-            }
-            else
-            {
-                withinBraces = false;
-
-                // Now we can evaluate the value between { and }
-                const System::Char * beforeEndBraces =  formatBuffer - 2;   // Character just before the brace
-                beforeEndBraces;
-                // Because that's a Format function with just one parameter, only 0 is expected
-                CROSSNET_ASSERT(afterStartBraces == beforeEndBraces, "");
-                CROSSNET_ASSERT(*afterStartBraces == L'0', "");
-
-                if (string0 == NULL)
-                {
-                    // We did not get the string yet, get it only one time,
-                    // even if {0} is referenced several times...
-                    string0 = arg0->ToString();
-                }
-
-                // Replace "{0}" by the stringified arg0
-                strBuilder->Append(string0);
-            }
-        }
-        else
-        {
-            if (c != L'{')
-            {
-                strBuilder->Append(c);
-            }
-            else
-            {
-                withinBraces = true;
-                afterStartBraces = formatBuffer;
-            }
-        }
-    }
-    return (strBuilder->ToString());
+System::String * String::Format(System::String * format, System::Object * arg0, System::Object * arg1, System::Object * arg2)
+{
+    System::Object * args[] = { arg0, arg1, arg2 };
+    return (FormatArgs(NULL, format, args, 3));
+}
+
+System::String * String::Format(System::String * format, System::Array__G<System::Object *> * args)
+{
+    return (Format(NULL, format, args));
+}
+
+System::String * String::Format(System::IFormatProvider * provider, System::String * format, System::Array__G<System::Object *> * args)
+{
+    CROSSNET_ASSERT(args != NULL, "The arguments can't be NULL!");
+    return (FormatArgs(provider, format, args->__ToPointer__(), args->get_Length()));
 }
 
 System::String * String::Concat(System::Array__G<System::Object *> * array)
 {
-    System::Int32 totalSize = 1;
     int arrayLength = array->get_Length();
 
     // Reserve room for the string pointers
-    System::String * * allStrs = (System::String * *)_alloca(arrayLength * sizeof(System::String *));
-
-    // Get all the strings, stores them in a temporary array and calculate the total length
-    for (int i = 0 ; i < arrayLength ; ++i)
-    {
-        System::Object * obj = array->SingleDimensionItem(i);
-        System::String * str = obj->ToString();
-        allStrs[i] = str;
-        totalSize += str->get_Length();
-    }
+    const System::String * * allStrs = (const System::String * *)_alloca(arrayLength * sizeof(System::String *));
 
-    // Now fill the buffer...
-    System::String * concatString = __Create__(totalSize);
-    System::Char * buffer = const_cast<System::Char *>(concatString->__ToCString__());
-    int offset = 0;
+    // Get all the strings, stores them in a temporary array
     for (int i = 0 ; i < arrayLength ; ++i)
     {
-        System::String * str = allStrs[i];
-        wcscpy_s(buffer + offset, totalSize - offset, str->__ToCString__());
-        offset += str->get_Length();
+        allStrs[i] = ToStringOrNull(array->SingleDimensionItem(i));
     }
 
-    CROSSNET_ASSERT(offset + 1 == totalSize, "");
-
     // allStrs is deallocated at the end of this method...
-    return (concatString);
+    return (__Concat__(allStrs, arrayLength));
 }
 
 System::String * String::Concat(System::Array__G<System::String *> * array)
 {
-    System::Int32 totalSize = 1;
-    int arrayLength = array->get_Length();
-
-    // Calculate the total length
-    for (int i = 0 ; i < arrayLength ; ++i)
-    {
-        System::String * str = array->SingleDimensionItem(i);
-        totalSize += str->get_Length();
-    }
-
-    // Now fill the buffer...
-    System::String * concatString = __Create__(totalSize);
-    System::Char * buffer = const_cast<System::Char *>(concatString->__ToCString__());
-    int offset = 0;
-    for (int i = 0 ; i < arrayLength ; ++i)
-    {
-        System::String * str = array->SingleDimensionItem(i);
-        wcscpy_s(buffer + offset, totalSize - offset, str->__ToCString__());
-        offset += str->get_Length();
-    }
-
-    CROSSNET_ASSERT(offset + 1 == totalSize, "");
-
-    return (concatString);
+    return (__Concat__(array->__ToPointer__(), array->get_Length()));
 }
 
 System::Boolean String::Contains(String * value)
 {
-    value;
-    CROSSNET_NOT_IMPLEMENTED();
-    return (false);
+    return (IndexOf(value) >= 0);
 }
 
 }
\ No newline at end of file
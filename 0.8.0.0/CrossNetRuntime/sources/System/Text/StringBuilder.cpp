@@ -13,8 +13,18 @@
     OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+
 #include "CrossNetRuntime/System/Text/StringBuilder.h"
+#include "CrossNetRuntime/System/Array.h"
 #include "CrossNetRuntime/System/String.h"
+#include "CrossNetRuntime/CompositeFormat.h"
+#include "CrossNetRuntime/Number.h"
+#include "CrossNetRuntime/GC/GCAllocator.h"
+#include "CrossNetRuntime/Internal/BaseTypes.h"
+#include "CrossNetRuntime/Internal/Chars.h"
+
+// For memmove
+#include <string.h>
 
 namespace System
 {
@@ -26,13 +36,21 @@ void * * StringBuilder::s__InterfaceMap__ = NULL;
 void StringBuilder::__RegisterId__()
 {
     s__InterfaceMap__ = CrossNetRuntime::InterfaceMapper::RegisterObject(sizeof(System::Text::StringBuilder));
+
+    // The only reference is the buffer
+    static const CrossNetRuntime::ReferenceOffset sReferenceOffsets[] =
+    {
+        CN_REFERENCE_OFFSET(StringBuilder, mBuffer),
+        CrossNetRuntime::END_OF_REFERENCE_OFFSETS,
+    };
+    CrossNetRuntime::InterfaceMapper::SetReferenceOffsets(s__InterfaceMap__, sReferenceOffsets);
 }
 
 StringBuilder::StringBuilder()
     :
+    mBuffer(NULL),
     mSize(0),
-    mCapacity(0),
-    mBuffer(NULL)
+    mShared(false)
 {
     m__InterfaceMap__ = __GetInterfaceMap__();
 }
@@ -50,85 +68,391 @@ StringBuilder * StringBuilder::__Create__(System::Int32 capacity)
     return (temp);
 }
 
+StringBuilder * StringBuilder::__Create__(System::String * text)
+{
+    StringBuilder * temp = new StringBuilder();
+    temp->Append(text);
+    return (temp);
+}
+
+StringBuilder * StringBuilder::__Create__(System::String * text, System::Int32 capacity)
+{
+    StringBuilder * temp = new StringBuilder();
+    temp->Reserve(capacity);
+    temp->Append(text);
+    return (temp);
+}
+
 System::String *    StringBuilder::ToString()
 {
     if (mSize == 0)
     {
         return (System::String::Empty);
     }
-    return (String::__Create__(mBuffer, 0, mSize));
+    if (mShared == false)
+    {
+        // Give the buffer to the string without copying it
+        //  The unused capacity goes back to the GC allocator
+        int size = mBuffer->__GetVariableSize__();
+        mBuffer->mLength = mSize;
+        mBuffer->mBuffer[mSize] = '\0';
+        CrossNetRuntime::GCAllocator::Shrink(mBuffer, size, mBuffer->__GetVariableSize__());
+        mShared = true;
+    }
+    // Until the next modification, ToString() keeps returning the same string
+    return (mBuffer);
+}
+
+System::String *    StringBuilder::ToString(System::Int32 startIndex, System::Int32 length)
+{
+    CROSSNET_ASSERT((startIndex >= 0) && (length >= 0) && (startIndex + length <= mSize), "Incorrect range!");
+    if ((startIndex == 0) && (length == mSize))
+    {
+        return (ToString());
+    }
+    return (System::String::__CreateWithLengthKnown__(mBuffer->mBuffer + startIndex, length));
 }
 
 StringBuilder * StringBuilder::Append(System::String * text)
 {
-    int stringLength = text->get_Length();
-    int newSize = mSize + stringLength + 1;     // +1 for the trailing '\0'
-    if (newSize > mCapacity)
+    if (text == NULL)
     {
-        Reserve(newSize);
+        return (this);
     }
-    // Copy the string and the trailing '\0' as well
-    wmemcpy(mBuffer + mSize, text->__ToCString__(), stringLength + 1);
-    mSize += stringLength;
-    CROSSNET_ASSERT(mSize + 1 <= mCapacity, "");
-    return (this);
+    return (AppendChars(text->mBuffer, text->mLength));
+}
+
+StringBuilder * StringBuilder::Append(System::String * text, System::Int32 startIndex, System::Int32 count)
+{
+    if (text == NULL)
+    {
+        CROSSNET_ASSERT((startIndex == 0) && (count == 0), "Incorrect range!");
+        return (this);
+    }
+    CROSSNET_ASSERT((startIndex >= 0) && (count >= 0) && (startIndex + count <= text->mLength), "Incorrect range!");
+    return (AppendChars(text->mBuffer + startIndex, count));
+}
+
+StringBuilder * StringBuilder::Append(System::Array__G<System::Char> * array)
+{
+    if (array == NULL)
+    {
+        return (this);
+    }
+    return (AppendChars(array->__ToPointer__(), array->get_Length()));
+}
+
+StringBuilder * StringBuilder::Append(System::Array__G<System::Char> * array, System::Int32 startIndex, System::Int32 count)
+{
+    if (array == NULL)
+    {
+        CROSSNET_ASSERT((startIndex == 0) && (count == 0), "Incorrect range!");
+        return (this);
+    }
+    CROSSNET_ASSERT((startIndex >= 0) && (count >= 0) && (startIndex + count <= array->get_Length()), "Incorrect range!");
+    return (AppendChars(array->__ToPointer__() + startIndex, count));
 }
 
 StringBuilder * StringBuilder::Append(System::Char c)
 {
-    int newSize = mSize + 1 + 1;                // +1 for the char and +1 for the trailing '\0'
-    if (newSize > mCapacity)
+    *AppendUninitialized(1) = c;
+    return (this);
+}
+
+StringBuilder * StringBuilder::Append(System::Char c, System::Int32 repeatCount)
+{
+    CROSSNET_ASSERT(repeatCount >= 0, "");
+    CrossNetRuntime::FillChars(AppendUninitialized(repeatCount), c, repeatCount);
+    return (this);
+}
+
+StringBuilder * StringBuilder::Append(System::Object * value)
+{
+    if (value == NULL)
+    {
+        return (this);
+    }
+    return (Append(value->ToString()));
+}
+
+StringBuilder * StringBuilder::Append(System::Boolean value)
+{
+    return (Append(value ? CrossNetRuntime::BaseTypeWrapper<System::Boolean>::TrueString : CrossNetRuntime::BaseTypeWrapper<System::Boolean>::FalseString));
+}
+
+// The numbers are formatted directly in the buffer, the same way as their ToString()
+
+StringBuilder * StringBuilder::Append(System::Byte value)
+{
+    return (AppendUnsigned((System::UInt32)value, false));
+}
+
+StringBuilder * StringBuilder::Append(System::SByte value)
+{
+    return (Append((System::Int32)value));
+}
+
+StringBuilder * StringBuilder::Append(System::Int16 value)
+{
+    return (Append((System::Int32)value));
+}
+
+StringBuilder * StringBuilder::Append(System::UInt16 value)
+{
+    return (AppendUnsigned((System::UInt32)value, false));
+}
+
+StringBuilder * StringBuilder::Append(System::Int32 value)
+{
+    // Negate as unsigned so Int32 min value is correct
+    System::UInt32 magnitude = (System::UInt32)value;
+    if (value < 0)
+    {
+        magnitude = 0 - magnitude;
+    }
+    return (AppendUnsigned(magnitude, value < 0));
+}
+
+StringBuilder * StringBuilder::Append(System::UInt32 value)
+{
+    return (AppendUnsigned(value, false));
+}
+
+StringBuilder * StringBuilder::Append(System::Int64 value)
+{
+    System::UInt64 magnitude = (System::UInt64)value;
+    if (value < 0)
+    {
+        magnitude = 0 - magnitude;
+    }
+    return (AppendUnsigned(magnitude, value < 0));
+}
+
+StringBuilder * StringBuilder::Append(System::UInt64 value)
+{
+    return (AppendUnsigned(value, false));
+}
+
+StringBuilder * StringBuilder::Append(System::Single value)
+{
+    System::Char number[CrossNetRuntime::Number::MAX_FLOAT_LENGTH];
+    return (AppendChars(number, CrossNetRuntime::Number::FormatSingle(number, value)));
+}
+
+StringBuilder * StringBuilder::Append(System::Double value)
+{
+    System::Char number[CrossNetRuntime::Number::MAX_FLOAT_LENGTH];
+    return (AppendChars(number, CrossNetRuntime::Number::FormatDouble(number, value)));
+}
+
+System::Int32   StringBuilder::get_Length()
+{
+    return (mSize);
+}
+
+System::Int32   StringBuilder::set_Length(System::Int32 length)
+{
+    CROSSNET_ASSERT(length >= 0, "");
+    if (length > mSize)
+    {
+        // Like .Net, pad with '\0'
+        CrossNetRuntime::FillChars(AppendUninitialized(length - mSize), '\0', length - mSize);
+    }
+    else if (length < mSize)
+    {
+        GetWritableBuffer();
+        mSize = length;
+    }
+    return (length);
+}
+
+System::Int32   StringBuilder::get_Capacity()
+{
+    if (mShared)
+    {
+        // The next modification will allocate a new buffer anyway
+        return (mSize);
+    }
+    return (GetCapacity());
+}
+
+System::Int32   StringBuilder::EnsureCapacity(System::Int32 capacity)
+{
+    Reserve(capacity);
+    return (get_Capacity());
+}
+
+System::Char StringBuilder::get_Item(System::Int32 index)
+{
+    CROSSNET_ASSERT((index >= 0) && (index < mSize), "Index out of range!");
+    return (mBuffer->mBuffer[index]);
+}
+
+System::Char StringBuilder::set_Item(System::Int32 index, System::Char c)
+{
+    CROSSNET_ASSERT((index >= 0) && (index < mSize), "Index out of range!");
+    GetWritableBuffer()[index] = c;
+    return (c);
+}
+
+StringBuilder * StringBuilder::Remove(System::Int32 index, System::Int32 length)
+{
+    CROSSNET_ASSERT((index >= 0) && (length >= 0) && (index + length <= mSize), "Incorrect range!");
+    if (length == 0)
     {
-        Reserve(newSize);
+        return (this);
     }
-    mBuffer[mSize] = c;
-    ++mSize;
-    mBuffer[mSize] = L'\0';
-    CROSSNET_ASSERT(mSize + 1 <= mCapacity, "");
+    System::Char * buffer = GetWritableBuffer();
+    memmove(buffer + index, buffer + index + length, (mSize - (index + length)) * sizeof(System::Char));
+    mSize -= length;
     return (this);
 }
 
-void    StringBuilder::Reserve(System::Int32 newSize)
+StringBuilder * StringBuilder::Insert(System::Int32 index, System::String * value, System::Int32 count)
 {
-    if (newSize <= mCapacity)
+    CROSSNET_ASSERT((index >= 0) && (index <= mSize) && (count >= 0), "Incorrect range!");
+    if (value == NULL)
     {
-        // Enough size already...
-        return;
+        return (this);
     }
+    System::Int32 length = value->get_Length();
+    System::Int32 numChars = length * count;
+    if (numChars == 0)
+    {
+        return (this);
+    }
+    System::Int32 oldSize = mSize;
+    AppendUninitialized(numChars);
+    System::Char * buffer = mBuffer->mBuffer;
+    memmove(buffer + index + numChars, buffer + index, (oldSize - index) * sizeof(System::Char));
+    const System::Char * text = value->__ToCString__();
+    for (System::Char * destination = buffer + index ; count != 0 ; --count, destination += length)
+    {
+        memcpy(destination, text, length * sizeof(System::Char));
+    }
+    return (this);
+}
 
-    if (mCapacity == 0)
+StringBuilder * StringBuilder::AppendFormat(System::String * format, System::Object * arg0)
+{
+    CrossNetRuntime::CompositeFormat::Append(this, NULL, format, &arg0, 1);
+    return (this);
+}
+
+StringBuilder * StringBuilder::AppendFormat(System::String * format, System::Object * arg0, System::Object * arg1)
+{
+    System::Object * args[] = { arg0, arg1 };
+    CrossNetRuntime::CompositeFormat::Append(this, NULL, format, args, 2);
+    return (this);
+}
+
+StringBuilder * StringBuilder::AppendFormat(System::String * format, System::Object * arg0, System::Object * arg1, System::Object * arg2)
+{
+    System::Object * args[] = { arg0, arg1, arg2 };
+    CrossNetRuntime::CompositeFormat::Append(this, NULL, format, args, 3);
+    return (this);
+}
+
+StringBuilder * StringBuilder::AppendFormat(System::String * format, System::Array__G<System::Object *> * args)
+{
+    return (AppendFormat(NULL, format, args));
+}
+
+StringBuilder * StringBuilder::AppendFormat(System::IFormatProvider * provider, System::String * format, System::Array__G<System::Object *> * args)
+{
+    CROSSNET_ASSERT(args != NULL, "The arguments can't be NULL!");
+    CrossNetRuntime::CompositeFormat::Append(this, provider, format, args->__ToPointer__(), args->get_Length());
+    return (this);
+}
+
+System::Char *  StringBuilder::AppendUninitialized(System::Int32 numChars)
+{
+    CROSSNET_ASSERT(numChars >= 0, "");
+    System::Int32 newSize = mSize + numChars;
+    if (mShared || (newSize > GetCapacity()))
     {
-        // This is actually the first allocation through the StringBuilder
-        // The allocation doesn't have to copy from the previous buffer
-        CROSSNET_ASSERT(mSize == 0, "");
-        CROSSNET_ASSERT(mBuffer == NULL, "");
+        Grow(newSize);
+    }
+    System::Char * text = mBuffer->mBuffer + mSize;
+    mSize = newSize;
+    return (text);
+}
 
-        if (newSize < MIN_CAPACITY)
-        {
-            newSize = MIN_CAPACITY;
-        }
-        
-        mCapacity = newSize;
-        // mSize is 0 already
-        mBuffer = new System::Char[newSize];
-        return;
+System::Char *  StringBuilder::GetWritableBuffer()
+{
+    if (mShared)
+    {
+        // The current buffer belongs to a string now, strings are immutable
+        Grow(mSize);
     }
+    return (mBuffer->mBuffer);
+}
 
-    // if we grow, at minimum grow by 25%
-    int incrementalCapacity = (mCapacity * 10) / 8;
-    if (incrementalCapacity > newSize)
+void    StringBuilder::Reserve(System::Int32 newSize)
+{
+    if (mShared || (newSize > GetCapacity()))
     {
-        newSize = incrementalCapacity;
+        Grow(newSize);
     }
+}
 
-    System::Char * newBuffer = new System::Char[newSize];
-    // Copy the whole buffer and the trailing '\0'
-    wmemcpy(newBuffer, mBuffer, mSize + 1);
+void    StringBuilder::Grow(System::Int32 newSize)
+{
+    // Geometric growth, so appending N characters copies less than 2 * N characters in total
+    System::Int32 capacity = 2 * GetCapacity();
+    if (capacity < newSize)
+    {
+        capacity = newSize;
+    }
+    if (capacity < MIN_CAPACITY)
+    {
+        capacity = MIN_CAPACITY;
+    }
 
-    delete[] mBuffer;
+    // The buffer is a string allocated on the GC heap, so the GC can collect it with the builder
+    System::String * newBuffer = System::String::__Create__(capacity + 1);     // +1 for the trailing '\0' (added by ToString())
+    if (mSize != 0)
+    {
+        CrossNetRuntime::CopyChars(newBuffer->mBuffer, mBuffer->mBuffer, mSize);
+    }
     mBuffer = newBuffer;
-    mCapacity = newSize;
+    mShared = false;
 }
 
+StringBuilder * StringBuilder::AppendChars(const System::Char * text, System::Int32 length)
+{
+    if (length != 0)
+    {
+        CrossNetRuntime::CopyChars(AppendUninitialized(length), text, length);
+    }
+    return (this);
+}
+
+StringBuilder * StringBuilder::AppendUnsigned(System::UInt32 value, bool negative)
+{
+    System::Int32 length = CrossNetRuntime::Number::CountDigits(value) + (negative ? 1 : 0);
+    System::Char * text = AppendUninitialized(length);
+    System::Char * start = CrossNetRuntime::Number::WriteDigits(text + length, value);
+    if (negative)
+    {
+        *--start = '-';
+    }
+    CROSSNET_ASSERT(start == text, "");
+    return (this);
+}
+
+StringBuilder * StringBuilder::AppendUnsigned(System::UInt64 value, bool negative)
+{
+    System::Int32 length = CrossNetRuntime::Number::CountDigits(value) + (negative ? 1 : 0);
+    System::Char * text = AppendUninitialized(length);
+    System::Char * start = CrossNetRuntime::Number::WriteDigits(text + length, value);
+    if (negative)
+    {
+        *--start = '-';
+    }
+    CROSSNET_ASSERT(start == text, "");
+    return (this);
+}
+
+}
 }
-}
\ No newline at end of file